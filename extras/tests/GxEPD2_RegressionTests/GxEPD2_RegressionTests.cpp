@@ -0,0 +1,318 @@
+// Regression tests for GxEPD2_BW on Raspberry Pi, no panel needed.
+// The controller stream is captured with GxEPD2_RecordingTransport:
+// - the controller memory written by the fast paths (fillRect, bitmap and glyph blits, display list pages, double buffer)
+//   is compared to a per-pixel reference, for every rotation, mirror setting, full and partial window and several page heights
+// - drawing from a display list must send the same controller stream as drawing directly
+//
+// build and run, from the library folder:
+//   g++ -std=gnu++17 -DRPI -Isrc -o regression extras/tests/GxEPD2_RegressionTests/GxEPD2_RegressionTests.cpp
+//       src/GxEPD2_EPD.cpp src/GxEPD2_Transport.cpp src/RPI_SPI.cpp src/GxEPD2_RecordingTransport.cpp
+//       src/GxEPD2_DisplayList.cpp src/gfx/*.cpp src/epd/GxEPD2_290_T94_V2.cpp -lwiringPi -lpthread
+//   ./regression
+// exits with the number of failed checks
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "gfx/GFX_Root.h"
+#include "GxEPD2_DisplayList.h"
+#include "GxEPD2_BW.h"
+#include "GxEPD2_RecordingTransport.h"
+#include "gfx/Fonts/FreeMonoBold9pt7b.h"
+
+// SSD1680 panel, not square and not a single page, x addressed in bytes
+typedef GxEPD2_290_T94_V2 Driver;
+static const uint16_t W = Driver::WIDTH, H = Driver::HEIGHT;
+
+GxEPD2_BW<Driver, Driver::HEIGHT> display(Driver(/*CS=*/ 8, /*DC=*/ 25, /*RST=*/ -1, /*BUSY=*/ 24));
+GxEPD2_RecordingTransport recorder(1 << 20);
+
+static const uint8_t pattern[] = {0xF0, 0x0F, 0x81, 0xAA, 0x55, 0x3C, 0xC3, 0xFF, 0x00, 0x7E, 0x18, 0xE7, 0x99, 0x66, 0x01, 0x80};
+
+// the drawing of all tests; draws the same to the display, the display list and the reference
+template <class G> void scene(G& g)
+{
+  int16_t w = g.width(), h = g.height();
+  g.setTextWrap(false);
+  g.fillRect(3, 5, w / 2 + 1, h / 3, GxEPD_BLACK);
+  g.fillRect(-7, h - 20, 30, 40, GxEPD_BLACK); // clipped
+  g.fillRect(w / 3, 9, 17, h / 2, GxEPD_BLACK, GxEPD2_EPD::XOR);
+  g.fillRect(w - 13, h / 4, 9, 11, GxEPD_WHITE, GxEPD2_EPD::INVERT_XOR);
+  g.drawFastHLine(1, h / 2 + 3, w - 5, GxEPD_BLACK);
+  g.drawFastVLine(w / 2 + 5, 2, h - 3, GxEPD_BLACK);
+  g.drawLine(0, 0, w - 1, h - 1, GxEPD_BLACK);
+  g.drawLine(w - 1, 3, 2, h - 7, GxEPD_BLACK, GxEPD2_EPD::INVERT_XOR);
+  g.drawRect(10, h / 2 - 20, w / 3, 41, GxEPD_BLACK);
+  g.drawCircle(w / 2, h / 2, 30, GxEPD_BLACK);
+  g.fillCircle(w - 20, h - 25, 18, GxEPD_BLACK);
+  g.drawRoundRect(5, h - 60, w / 2, 50, 9, GxEPD_BLACK);
+  g.fillRoundRect(w / 2 + 8, 20, w / 3, 37, 6, GxEPD_BLACK);
+  g.drawTriangle(4, h - 4, w / 2, h / 2 + 10, w - 3, h - 9, GxEPD_BLACK);
+  g.fillTriangle(w / 4, 30, w / 2 - 3, 70, 12, 81, GxEPD_BLACK);
+  // degenerate sizes GFX still draws, or draws nothing for
+  g.drawRoundRect(w - 30, 40, 0, 36, 7, GxEPD_BLACK);
+  g.drawRect(w - 40, 50, 0, 30, GxEPD_BLACK);
+  g.drawRect(w - 60, 90, 30, 0, GxEPD_BLACK);
+  g.fillRoundRect(w - 50, 60, 0, 40, 5, GxEPD_BLACK);
+  g.drawRoundRect(20, h - 40, -6, 30, 3, GxEPD_BLACK);
+  g.drawRoundRect(30, 30, 40, 30, -3, GxEPD_BLACK);
+  g.drawBitmap(15, 15, pattern, 0, 4, GxEPD_BLACK);
+  // bitmaps at odd positions and partly off screen
+  g.drawBitmap(33, 47, pattern, 16, 8, GxEPD_BLACK);
+  g.drawBitmap(w - 11, 7, pattern, 16, 8, GxEPD_BLACK, GxEPD_WHITE);
+  g.drawBitmap(-5, h / 3 + 2, pattern, 13, 8, GxEPD_WHITE);
+  g.drawBitmap(w / 2 - 3, h - 5, pattern, 8, 16, GxEPD_BLACK, GxEPD_WHITE);
+  // glyphs: classic font with and without background, scaled, and a GFX font
+  g.setFont(0);
+  g.setTextSize(1);
+  g.setTextColor(GxEPD_BLACK);
+  g.setCursor(7, 12);
+  g.print("Classic 0123");
+  g.setTextColor(GxEPD_WHITE, GxEPD_BLACK);
+  g.setCursor(w / 3, h / 2 + 15);
+  g.print("bg");
+  g.setTextSize(2, 3);
+  g.setTextColor(GxEPD_BLACK);
+  g.setCursor(-4, h / 3);
+  g.print("Big");
+  g.setFont(&FreeMonoBold9pt7b);
+  g.setTextSize(1);
+  g.setCursor(9, h - 30);
+  g.print("Glyphs gj!");
+  g.setTextSize(2);
+  g.setTextColor(GxEPD_WHITE);
+  g.setCursor(w / 4, 40);
+  g.print("Ab");
+  g.setFont(0);
+  g.setTextSize(1);
+  g.drawPixel(w / 2, h / 3, GxEPD_WHITE, GxEPD2_EPD::INVERT);
+  g.drawPixel(w - 1, h - 1, GxEPD_BLACK);
+}
+
+// the image GFX draws pixel by pixel, in controller memory layout; mapped as drawPixel() of GxEPD2_BW always did
+class Reference : public GFX
+{
+  public:
+    uint8_t ram[W / 8 * H];
+    Reference(uint8_t rotation, bool mirror) : GFX(W, H), _mirror(mirror)
+    {
+      setRotation(rotation);
+      memset(ram, 0xFF, sizeof(ram));
+      _pw_x = 0;
+      _pw_y = 0;
+      _pw_w = W;
+      _pw_h = H;
+    }
+    // as setPartialWindow() of GxEPD2_BW, in rotated coordinates
+    void setPartialWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+    {
+      switch (getRotation())
+      {
+        case 1: _pw_x = W - y - h; _pw_y = x; _pw_w = h; _pw_h = w; break;
+        case 2: _pw_x = W - x - w; _pw_y = H - y - h; _pw_w = w; _pw_h = h; break;
+        case 3: _pw_x = y; _pw_y = H - x - w; _pw_w = h; _pw_h = w; break;
+        default: _pw_x = x; _pw_y = y; _pw_w = w; _pw_h = h; break;
+      }
+      _pw_w = (_pw_w + _pw_x % 8 + 7) / 8 * 8;
+      _pw_x -= _pw_x % 8;
+    }
+    // not in GFX, as GxEPD2_BW draws them
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE)
+    {
+      fillRect(x, y, w, 1, color, mode);
+    }
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE)
+    {
+      fillRect(x, y, 1, h, color, mode);
+    }
+    void drawPixel(int16_t x, int16_t y, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE)
+    {
+      if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
+      if (_mirror) x = width() - x - 1;
+      int16_t t;
+      switch (getRotation())
+      {
+        case 1: t = x; x = W - y - 1; y = t; break;
+        case 2: x = W - x - 1; y = H - y - 1; break;
+        case 3: t = x; x = y; y = H - t - 1; break;
+      }
+      if ((x < _pw_x) || (x >= _pw_x + _pw_w) || (y < _pw_y) || (y >= _pw_y + _pw_h)) return;
+      uint8_t* p = ram + y * (W / 8) + x / 8;
+      uint8_t bit = 0x80 >> (x & 7), old = (*p & bit) ? 1 : 0, c = color & 1;
+      switch (mode)
+      {
+        case GxEPD2_EPD::OVERWRITE: break;
+        case GxEPD2_EPD::INVERT: c = !c; break;
+        case GxEPD2_EPD::XOR: c = old ^ c; break;
+        case GxEPD2_EPD::INVERT_XOR: c = old ^ !c; break;
+      }
+      if (c) *p |= bit;
+      else *p &= ~bit;
+    }
+  private:
+    bool _mirror;
+    uint16_t _pw_x, _pw_y, _pw_w, _pw_h;
+};
+
+// controller memory of the SSD1680 after the recorded stream: 0x24 current, 0x26 previous image
+struct Controller
+{
+  uint8_t ram[2][W / 8 * H];
+  Controller(const GxEPD2_RecordingTransport& rec)
+  {
+    memset(ram, 0x55, sizeof(ram)); // neither white nor black, must be written
+    uint8_t command = 0, arg[4] = {0, 0, 0, 0};
+    uint16_t n = 0, xs = 0, xe = W / 8 - 1, ys = 0, ye = H - 1, x = 0, y = 0;
+    for (uint32_t i = 0; i < rec.available(); i++)
+    {
+      GxEPD2_RecordingTransport::Event e = rec.event(i);
+      if (e.type == GxEPD2_RecordingTransport::COMMAND)
+      {
+        command = e.value;
+        n = 0;
+        continue;
+      }
+      if (e.type != GxEPD2_RecordingTransport::DATA) continue;
+      if (n < 4) arg[n] = e.value;
+      n++;
+      switch (command)
+      {
+        case 0x44: if (n == 2) { xs = arg[0]; xe = arg[1]; } break;
+        case 0x45: if (n == 4) { ys = arg[0] | (arg[1] << 8); ye = arg[2] | (arg[3] << 8); } break;
+        case 0x4E: x = arg[0]; break;
+        case 0x4F: if (n == 2) y = arg[0] | (arg[1] << 8); break;
+        case 0x24:
+        case 0x26:
+          if ((x < W / 8) && (y < H)) ram[command == 0x26][y * (W / 8) + x] = e.value;
+          if (++x > xe) // data entry mode 0x03: x increments, then y
+          {
+            x = xs;
+            if (++y > ye) y = ys;
+          }
+          break;
+      }
+    }
+  }
+};
+
+static int failed = 0;
+
+static void check(bool ok, const char* what, int rotation, bool mirror, bool partial, uint16_t page_height)
+{
+  if (ok) return;
+  printf("FAILED %s: rotation %d, mirror %d, %s window, page height %d\n", what, rotation, mirror, partial ? "partial" : "full", page_height);
+  failed++;
+}
+
+static std::vector<uint8_t> stream()
+{
+  std::vector<uint8_t> v;
+  for (uint32_t i = 0; i < recorder.available(); i++)
+  {
+    GxEPD2_RecordingTransport::Event e = recorder.event(i);
+    v.push_back(e.type);
+    v.push_back(e.value);
+  }
+  return v;
+}
+
+static void drawCallback(const void*)
+{
+  scene(display);
+}
+
+enum Method
+{
+  PAGE_LOOP, DRAW_PAGED, LIST_DRAW_PAGED, LIST_CONCURRENT, LIST_PAGE_LOOP, DISPLAY, DISPLAY_SWAP
+};
+static const char* method_names[] = {"firstPage/nextPage", "drawPaged", "drawPaged(list)", "drawPaged(list, 4)", "setDisplayList", "display", "displaySwap"};
+
+// draws the scene with method, returns the controller stream
+static std::vector<uint8_t> run(Method method, uint8_t rotation, bool mirror, bool partial, uint16_t page_height)
+{
+  display.init(0);
+  display.setPageHeight(page_height);
+  display.setRotation(rotation);
+  display.mirror(mirror);
+  if (partial) display.setPartialWindow(13, 21, 77, 90);
+  else display.setFullWindow();
+  GxEPD2_DisplayList list(W, H);
+  list.setRotation(rotation);
+  scene(list);
+  recorder.clear();
+  switch (method)
+  {
+    case PAGE_LOOP:
+    case LIST_PAGE_LOOP:
+      display.setDisplayList(method == LIST_PAGE_LOOP ? &list : 0);
+      display.firstPage();
+      do
+      {
+        scene(display);
+      }
+      while (display.nextPage());
+      display.setDisplayList(0);
+      break;
+    case DRAW_PAGED: display.drawPaged(drawCallback, 0); break;
+    case LIST_DRAW_PAGED: display.drawPaged(list, 1); break;
+    case LIST_CONCURRENT: display.drawPaged(list, 4); break;
+    case DISPLAY:
+      display.fillScreen(GxEPD_WHITE);
+      scene(display);
+      display.display(false);
+      break;
+    case DISPLAY_SWAP:
+      display.setDoubleBuffer(true);
+      display.fillScreen(GxEPD_WHITE);
+      scene(display);
+      display.displaySwap(true).wait();
+      display.setDoubleBuffer(false);
+      break;
+  }
+  return stream();
+}
+
+int main()
+{
+  display.epd2.setTransport(&recorder);
+  const uint16_t page_heights[] = {H, 100, 64, 7};
+  for (uint8_t rotation = 0; rotation < 4; rotation++)
+  {
+    for (int mirror = 0; mirror < 2; mirror++)
+    {
+      for (int partial = 0; partial < 2; partial++)
+      {
+        Reference reference(rotation, mirror);
+        if (partial) reference.setPartialWindow(13, 21, 77, 90);
+        scene(reference);
+        for (uint16_t page_height : page_heights)
+        {
+          std::vector<uint8_t> direct, paged;
+          for (int m = PAGE_LOOP; m <= DISPLAY_SWAP; m++)
+          {
+            Method method = Method(m);
+            if ((method >= DISPLAY) && (partial || (page_height != H))) continue; // full screen buffer only
+            std::vector<uint8_t> s = run(method, rotation, mirror, partial, page_height);
+            Controller controller(recorder);
+            check(recorder.dropped() == 0, "recorder capacity", rotation, mirror, partial, page_height);
+            check(memcmp(controller.ram[0], reference.ram, sizeof(reference.ram)) == 0, method_names[m], rotation, mirror, partial, page_height);
+            check(memcmp(controller.ram[1], reference.ram, sizeof(reference.ram)) == 0, method_names[m], rotation, mirror, partial, page_height);
+            // the same controller stream with and without a display list
+            if (method == PAGE_LOOP) direct = s;
+            if (method == DRAW_PAGED) paged = s;
+            if (method == LIST_PAGE_LOOP) check(s == direct, "stream of setDisplayList vs. firstPage/nextPage", rotation, mirror, partial, page_height);
+            if ((method == LIST_DRAW_PAGED) || (method == LIST_CONCURRENT)) check(s == paged, "stream of drawPaged(list) vs. drawPaged", rotation, mirror, partial, page_height);
+          }
+        }
+      }
+    }
+  }
+  printf("%s, %d failed\n", failed ? "FAILED" : "passed", failed);
+  return failed;
+}
@@ -1,304 +1,578 @@
-/*****************************************************************************
-* | File      	:   GUI_BMPfile.h
-* | Author      :   Waveshare team
-* | Function    :   Hardware underlying interface
-* | Info        :
-*                Used to shield the underlying layers of each master
-*                and enhance portability
-*----------------
-* |	This version:   V2.2
-* | Date        :   2020-07-08
-* | Info        :
-* -----------------------------------------------------------------------------
-* V2.2(2020-07-08):
-* 1.Add GUI_ReadBmp_RGB_7Color()
-* V2.1(2019-10-10):
-* 1.Add GUI_ReadBmp_4Gray()
-* V2.0(2018-11-12):
-* 1.Change file name: GUI_BMP.h -> GUI_BMPfile.h
-* 2.fix: GUI_ReadBmp()
-*   Now xStart and xStart can control the position of the picture normally,
-*   and support the display of images of any size. If it is larger than
-*   the actual display range, it will not be displayed.
-#
-# Permission is hereby granted, free of charge, to any person obtaining a copy
-# of this software and associated documnetation files (the "Software"), to deal
-# in the Software without restriction, including without limitation the rights
-# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-# copies of the Software, and to permit persons to  whom the Software is
-# furished to do so, subject to the following conditions:
-#
-# The above copyright notice and this permission notice shall be included in
-# all copies or substantial portions of the Software.
-#
-# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-# FITNESS OR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-# LIABILITY WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
-# THE SOFTWARE.
-#
-******************************************************************************/
-
-#include <stdio.h>
-
-//#define DEBUG
-#include "Debug.h"
-#include "BMPfile.h"
+/*****************************************************************************
+* | File      	:   GUI_BMPfile.h
+* | Author      :   Waveshare team
+* | Function    :   Hardware underlying interface
+* | Info        :
+*                Used to shield the underlying layers of each master
+*                and enhance portability
+*----------------
+* |	This version:   V2.2
+* | Date        :   2020-07-08
+* | Info        :
+* -----------------------------------------------------------------------------
+* V2.2(2020-07-08):
+* 1.Add GUI_ReadBmp_RGB_7Color()
+* V2.1(2019-10-10):
+* 1.Add GUI_ReadBmp_4Gray()
+* V2.0(2018-11-12):
+* 1.Change file name: GUI_BMP.h -> GUI_BMPfile.h
+* 2.fix: GUI_ReadBmp()
+*   Now xStart and xStart can control the position of the picture normally,
+*   and support the display of images of any size. If it is larger than
+*   the actual display range, it will not be displayed.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documnetation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to  whom the Software is
+# furished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS OR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#
+******************************************************************************/
+
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//#define DEBUG
+#include "Debug.h"
+#include "BMPfile.h"
 #include "GxEPD2.h"
-
-/*Bitmap file header   14 bytes */
-typedef struct {
-    uint16_t type;      //File identifier
-    uint32_t size;      //The size of the file
-    uint16_t reserved1; //Reserved value, must be set to 0
-    uint16_t reserved2; //Reserved value, must be set to 0
-    uint32_t offset;    // Ofset from beginning of file to beginning of image data
-} __attribute__ ((packed)) HEADER;    // 14bit
-
-/*Bitmap information header  40bit*/
-typedef struct {
-    uint32_t infoSize;          //The size of the header
-    uint32_t width;             //The width of the image
-    uint32_t height;            //The height of the image
-    uint16_t planes;            //The number of planes in the image
-    uint16_t bitCount;          //The number of bits per pixel
-    uint32_t compression;       //Compression type
-    uint32_t imageSize;         //The size of the image, in bytes
-    uint32_t xResolution;       //Horizontal resolution
-    uint32_t yResolution;       //Vertical resolution
-    uint32_t colours;           //The number of colors used
-    uint32_t coloursImportant;  //The number of important colors
-} __attribute__ ((packed)) INFO;
-
-/*Color table: palette */
-typedef struct {
-    uint8_t blue;               //Blue intensity
-    uint8_t green;              //Green strength
-    uint8_t red;                //Red intensity
-    uint8_t reversed;           //Reserved value
-} __attribute__ ((packed)) RGBQUAD;
-
-/*************************************************************************
-
-Read a monochrome (single-bit) bitmap from a .BMP file to a specified location in the display buffer
-This does not actually update the display itself
-
-Params: path -- path to file
-        info: BMP INFO structure to return width asnd height
-Returns: pointer to data
-*************************************************************************/
-
-bool BMPfile::readBmpMono(const char *path, uint8_t *buffer, int16_t dispXBytes, int16_t dispY, uint16_t dispWidth, uint16_t dispHeight, GxEPD2_EPD::writeMode mode, bool mirrorY) {
-    Debug("readBmpMono %s, %d, %d, %d, %d\n", path, dispXBytes, dispY, dispWidth, dispHeight);
-    FILE *fp;
-    if((fp = fopen(path, "rb")) == NULL) {
-        Debug("Can't open %s\n", path);
-        return false;
-    }
-
+
+/*Bitmap file header   14 bytes */
+typedef struct {
+    uint16_t type;      //File identifier
+    uint32_t size;      //The size of the file
+    uint16_t reserved1; //Reserved value, must be set to 0
+    uint16_t reserved2; //Reserved value, must be set to 0
+    uint32_t offset;    // Ofset from beginning of file to beginning of image data
+} __attribute__ ((packed)) HEADER;    // 14bit
+
+/*Bitmap information header  40bit*/
+typedef struct {
+    uint32_t infoSize;          //The size of the header
+    uint32_t width;             //The width of the image
+    uint32_t height;            //The height of the image
+    uint16_t planes;            //The number of planes in the image
+    uint16_t bitCount;          //The number of bits per pixel
+    uint32_t compression;       //Compression type
+    uint32_t imageSize;         //The size of the image, in bytes
+    uint32_t xResolution;       //Horizontal resolution
+    uint32_t yResolution;       //Vertical resolution
+    uint32_t colours;           //The number of colors used
+    uint32_t coloursImportant;  //The number of important colors
+} __attribute__ ((packed)) INFO;
+
+/*Color table: palette */
+typedef struct {
+    uint8_t blue;               //Blue intensity
+    uint8_t green;              //Green strength
+    uint8_t red;                //Red intensity
+    uint8_t reversed;           //Reserved value
+} __attribute__ ((packed)) RGBQUAD;
+
+/*************************************************************************
+
+Map a .BMP file into memory and check its headers
+
+Params: path -- path to file
+Returns: false if the file can't be read, or is not an uncompressed bitmap with all its rows present
+*************************************************************************/
+
+bool BMPfile::Image::open(const char *path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        Debug("Can't open %s\n", path);
+        return false;
+    }
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (size_t(st.st_size) < sizeof(HEADER) + sizeof(INFO))) {
+        Debug("%s is too short for a bitmap\n", path);
+        ::close(fd);
+        return false;
+    }
+    _size = st.st_size;
+    void *map = mmap(0, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED) {
+        _data = (uint8_t *)map;
+        _mapped = true;
+    } else if ((_data = (uint8_t *)malloc(_size)) != NULL) {
+        // e.g. a pipe or a file system without mmap: read it in large blocks
+        size_t n = 0;
+        ssize_t r;
+        while ((n < _size) && ((r = read(fd, _data + n, _size - n)) > 0)) n += r;
+        if (n < _size) {
+            Debug("read failed: %s\n", path);
+            ::close(fd);
+            close();
+            return false;
+        }
+    }
+    ::close(fd);
+    if (!_data) return false;
+
     HEADER header;
     INFO info;
-
-    fseek(fp, 0, SEEK_SET);
-    fread(&header, sizeof(header), 1, fp);    //sizeof(header) must be 14
-    fread(&info, sizeof(INFO), 1, fp);    //sizeof(info) must be 50
-    Debug("%d * %d, bit count = %d, compression = %d\n", info.width, info.height, info.bitCount, info.compression);
-
-    // Determine if it is a monochrome bitmap
-    if(info.bitCount != 1) {
-        Debug("%s is not a monochrome bitmap!\n", path);
-        fclose(fp);
-        return false;
-    }
-
-    // Determine if it is a compressed bitmap
-    if(info.compression != 0) {
-        Debug("%s is a compressed bitmap!\n", path);
-        fclose(fp);
-        return false;
-    }
-
-
-    // Ignore palette
-//    uint16_t rgbQuadSize = 1 << info.bitCount;// 2^1 = 2
-//    RGBQUAD rgbQuad[rgbQuadSize];        //palette
-//    fread(&rgbQuad, sizeof(RGBQUAD), rgbQuadSize, fp);
-
-    uint16_t widthBytes = (info.width + 7) >> 3;
-    if (dispY < 0) {
-        fseek(fp, widthBytes * -dispY, SEEK_CUR);
-        info.height += dispY;
-        dispY = 0;
-    }
-    if (dispY + info.height > dispHeight) info.height = dispHeight - dispY;
-
-    uint16_t dispWidthBytes = (dispWidth + 7) >> 3;
-    uint16_t readBytes = (dispXBytes + widthBytes > dispWidth) ? (dispWidth - dispXBytes) : widthBytes;
-
-    // Read image data into the buffer
-    fseek(fp, header.offset, SEEK_SET);
-    Debug("dispXBytes = %0x\n", dispXBytes);
-    for(uint16_t y = 0; y < info.height; y++) { //Total display column
-        Debug("\n%3d: ", y + dispY);
-        if (dispXBytes < 0) {
-            fseek(fp, -dispXBytes, SEEK_CUR);
-        }
-        for (uint16_t x = 0; x < readBytes; x++) {
-            uint8_t data = 0xa5;
-            if (fread(&data, 1, 1, fp) != 1) {
-                Debug("read failed: %s\n", path);
-                fclose(fp);
-                return false;
+    memcpy(&header, _data, sizeof(header));
+    memcpy(&info, _data + sizeof(header), sizeof(info));
+    Debug("%d * %d, bit count = %d, compression = %d\n", info.width, info.height, info.bitCount, info.compression);
+    // a negative height is a top-down bitmap
+    int32_t height = int32_t(info.height);
+    bool valid = (header.type == 0x4D42) && (info.infoSize >= sizeof(INFO)) && (info.planes == 1) && (info.width > 0) && (info.width < 0x8000)
+                 && (height != 0) && (height > -0x8000) && (height < 0x8000) && (header.offset <= _size);
+    switch (info.bitCount) {
+    case 1: case 4: case 8: case 16: case 24: case 32: break;
+    default: valid = false;
+    }
+    // compression: 0 none, 1 RLE8, 2 RLE4, 3 bit fields; RLE bitmaps are bottom-up
+    switch (info.compression) {
+    case 0: break;
+    case 1: valid = valid && (info.bitCount == 8) && (height > 0); break;
+    case 2: valid = valid && (info.bitCount == 4) && (height > 0); break;
+    case 3: valid = valid && ((info.bitCount == 16) || (info.bitCount == 32)); break;
+    default: valid = false;
+    }
+    if (!valid) {
+        Debug("%s is not a bitmap, or compressed in a way not supported!\n", path);
+        close();
+        return false;
+    }
+    _width = info.width;
+    _height = height < 0 ? -height : height;
+    _topDown = height < 0;
+    _bitCount = info.bitCount;
+    _stride = ((uint64_t(_width) * _bitCount + 31) / 32) * 4;
+    _pixels = _data + header.offset;
+    _pixelBytes = _size - header.offset;
+    if ((info.compression == 1) || (info.compression == 2)) {
+        if (!_indexRle(_bitCount)) {
+            close();
+            return false;
+        }
+    } else if (uint64_t(_stride) * _height > _pixelBytes) {
+        Debug("%s is truncated\n", path);
+        close();
+        return false;
+    }
+    // channel masks of 16 and 32 bit rows: after a 40 byte header, or in the larger headers
+    _bitfields = (info.compression == 3) || (_bitCount == 16);
+    uint32_t masks[3] = {0x7C00, 0x03E0, 0x001F};
+    if (info.compression == 3) {
+        if (sizeof(HEADER) + uint64_t(sizeof(INFO)) + sizeof(masks) > header.offset) {
+            Debug("%s has no bit field masks\n", path);
+            close();
+            return false;
+        }
+        memcpy(masks, _data + sizeof(HEADER) + sizeof(INFO), sizeof(masks));
+    }
+    for (uint8_t c = 0; c < 3; c++) {
+        _mask[c] = masks[c];
+        _shift[c] = masks[c] ? __builtin_ctz(masks[c]) : 0;
+        _bits[c] = __builtin_popcount(masks[c]);
+    }
+    // color table after the information header
+    if (_bitCount <= 8) {
+        _colours = info.colours ? info.colours : 1u << _bitCount;
+        if ((_colours > 1u << _bitCount) || (sizeof(HEADER) + uint64_t(info.infoSize) + 4 * _colours > header.offset)) {
+            Debug("%s has a bad color table\n", path);
+            close();
+            return false;
+        }
+        _palette = _data + sizeof(HEADER) + info.infoSize;
+    }
+    return true;
+}
+
+void BMPfile::Image::rgbRow(uint32_t i, uint8_t *r, uint8_t *g, uint8_t *b) const {
+    const uint8_t *src = row(i);
+    switch (_bitCount) {
+    case 1: case 4: case 8: {
+        uint8_t shift = 8 - _bitCount, mask = (1 << _bitCount) - 1;
+        for (uint32_t x = 0; x < _width; x++) {
+            uint32_t bit = x * _bitCount;
+            uint8_t k = (src[bit >> 3] >> (shift - (bit & 7))) & mask;
+            const uint8_t *c = k < _colours ? _palette + 4 * k : (const uint8_t *)"\0\0\0";
+            b[x] = c[0];
+            g[x] = c[1];
+            r[x] = c[2];
+        }
+        break;
+    }
+    case 16: // 5 bits each of red, green and blue, or bit fields
+    case 32:
+        if (_bitfields) {
+            uint8_t *out[3] = {r, g, b};
+            for (uint8_t c = 0; c < 3; c++) {
+                uint8_t *o = out[c], shift = _shift[c], bits = _bits[c];
+                uint32_t mask = _mask[c], max = bits ? (1ul << (bits > 8 ? 8 : bits)) - 1 : 1;
+                for (uint32_t x = 0; x < _width; x++) {
+                    uint32_t v = _bitCount == 16 ? src[2 * x] | (src[2 * x + 1] << 8) : src[4 * x] | (src[4 * x + 1] << 8) | (src[4 * x + 2] << 16) | (uint32_t(src[4 * x + 3]) << 24);
+                    v = (v & mask) >> shift;
+                    if (bits > 8) v >>= bits - 8;
+                    o[x] = v * 255 / max;
+                }
             }
-             switch (mode) {
-            case GxEPD2_EPD::OVERWRITE: buffer[(dispY + (mirrorY ? info.height - y - 1: y)) * dispWidthBytes + dispXBytes + x] = data; break;
-            case GxEPD2_EPD::INVERT: buffer[(dispY + (mirrorY ? info.height - y - 1: y)) * dispWidthBytes + dispXBytes + x] = ~data; break;
-            case GxEPD2_EPD::XOR: buffer[(dispY + (mirrorY ? info.height - y - 1: y)) * dispWidthBytes + dispXBytes + x] ^= data; break;
-            case GxEPD2_EPD::INVERT_XOR: buffer[(dispY + (mirrorY ? info.height - y - 1: y)) * dispWidthBytes + dispXBytes + x] ^= ~data; break;
+            break;
+        }
+        // fall through
+    default: // 24 and 32 bit: blue, green, red and, for 32 bit, unused
+        uint8_t n = _bitCount / 8;
+        for (uint32_t x = 0; x < _width; x++, src += n) {
+            b[x] = src[0];
+            g[x] = src[1];
+            r[x] = src[2];
+        }
+        break;
+    }
+}
+
+// codes of RLE8 and RLE4 rows: a count of pixels and the color index, two indexes for RLE4, or 0 and
+// 0 end of row, 1 end of bitmap, 2 dx dy jump, 3..255 that many indexes as they are, padded to 16 bits.
+// Pixels not coded, e.g. jumped over, have index 0
+
+// finds where each row starts, rows are then decoded when they are used
+bool BMPfile::Image::_indexRle(uint8_t bits) {
+    _rleStart = new (std::nothrow) uint32_t[_height];
+    _rleX = new (std::nothrow) uint32_t[_height];
+    _line = new (std::nothrow) uint8_t[_stride];
+    if (!_rleStart || !_rleX || !_line) return false;
+    for (uint32_t i = 0; i < _height; i++) _rleStart[i] = UINT32_MAX;
+    const uint8_t *p = _pixels;
+    size_t n = _pixelBytes, pos = 0;
+    uint32_t x = 0, y = 0;
+    _rleStart[0] = 0;
+    _rleX[0] = 0;
+    while ((y < _height) && (pos + 2 <= n)) {
+        uint8_t count = p[pos], code = p[pos + 1];
+        pos += 2;
+        if (count > 0) {
+            x += count;
+            continue;
+        }
+        if (code == 1) break;
+        if (code == 0) {
+            x = 0;
+            y++;
+        } else if (code == 2) {
+            if (pos + 2 > n) break;
+            x += p[pos];
+            y += p[pos + 1];
+            pos += 2;
+            if (p[pos - 1] == 0) continue;
+        } else {
+            uint32_t bytes = bits == 8 ? code : (code + 1) / 2;
+            pos += (bytes + 1) & ~1u;
+            continue;
+        }
+        if (y < _height) {
+            _rleStart[y] = pos;
+            _rleX[y] = x;
+        }
+    }
+    return true;
+}
+
+const uint8_t* BMPfile::Image::_decode(uint32_t i) const {
+    memset(_line, 0, _stride);
+    if (_rleStart[i] == UINT32_MAX) return _line;
+    const uint8_t *p = _pixels;
+    size_t n = _pixelBytes, pos = _rleStart[i];
+    uint32_t x = _rleX[i];
+    bool rle4 = _bitCount == 4;
+    while (pos + 2 <= n) {
+        uint8_t count = p[pos], code = p[pos + 1];
+        pos += 2;
+        if (count > 0) {
+            // a run: one index, or for RLE4 two alternating
+            for (uint8_t k = 0; (k < count) && (x < _width); k++, x++) {
+                if (rle4) _line[x >> 1] |= ((k & 1 ? code : code >> 4) & 0x0F) << (x & 1 ? 0 : 4);
+                else _line[x] = code;
             }
-            Debug("%02x/%02x ", before, buffer[(y + dispY) * dispWidthBytes + dispXBytes + x]);
+            continue;
+        }
+        if ((code == 0) || (code == 1)) break;
+        if (code == 2) {
+            if ((pos + 2 > n) || (p[pos + 1] != 0)) break; // the jump leaves this row
+            x += p[pos];
+            pos += 2;
+            continue;
+        }
+        // indexes as they are
+        uint32_t bytes = rle4 ? (code + 1) / 2 : code;
+        if (pos + bytes > n) break;
+        for (uint8_t k = 0; (k < code) && (x < _width); k++, x++) {
+            if (rle4) _line[x >> 1] |= ((k & 1 ? p[pos + k / 2] : p[pos + k / 2] >> 4) & 0x0F) << (x & 1 ? 0 : 4);
+            else _line[x] = p[pos + k];
         }
-        if (readBytes < widthBytes)
-            fseek(fp, widthBytes - readBytes, SEEK_CUR);
-        if (widthBytes & 0x03)
-            fseek(fp, 4 - (widthBytes & 0x03), SEEK_CUR);
-     }
-    Debug("\n\n");
-    fclose(fp);
-    return true;
-}
-
-/*************************************************************************
-
-Read a gray-scale (4-bit) bitmap from a .BMP file to a specified location in the display buffer.
-This does not actually update the display itself
-UNTESTED!!!!!
-Params: path -- path to file
-        buffer: buffer to read to (assumed to be the same format as the bitmap -- bit 7 of byte = first bit
-        xStart, yStart: coordinates of the top-left corner of the image (may be negative)
-        bufWidth, bufHeight: Width & Height of display, for clipping
-        invert: Invert image colours (0xff = invert, 0x00 = don't change)
-        mirrorY: Invert the image in the Y axis
-
-*************************************************************************/
-bool BMPfile::readBmp4Gray(const char *path, uint8_t *buffer, int16_t xStart, int16_t yStart, uint16_t bufWidth, uint16_t bufHeight, uint8_t invert, bool mirrorY) {
-    // Binary file open
-    FILE *fp;
-    if((fp = fopen(path, "rb")) == NULL) {
-        Debug("Can't open %s\n", path);
-        return false;
-    }
-
-    HEADER header;           //bmp
-
-    INFO info;
-    // Set the file pointer from the beginning
-    fseek(fp, 0, SEEK_SET);
-    fread(&header, sizeof(header), 1, fp);    //sizeof(header) must be 14
-    fread(&info, sizeof(INFO), 1, fp);    //sizeof(header) must be 50
-    Debug("pixel = %d * %d\r\n", info.width, info.height);
-
-    // Determine if it is a monochrome bitmap
-    if(info.bitCount != 4) {
-        Debug("%s is not a 4-bit bitmap!\n", path);
-        return false;
-    }
-
-    uint16_t Image_Width_Byte = (info.width % 4 == 0)? (info.width / 4): (info.width / 4 + 1);
-    uint16_t bufWidthByte = (bufWidth % 2 == 0)? (bufWidth / 2): (bufWidth / 2 + 1);
-    uint16_t Bmp_Width_Byte = (Image_Width_Byte % 2 == 0) ? Image_Width_Byte: ((Image_Width_Byte / 2 + 1) * 4);
-
-    // Read image data into the buffer
-    uint8_t Rdata;
-    fseek(fp, header.offset, SEEK_SET);
-
-    for(uint16_t y = 0; y < info.height; y++) {//Total display column
-        for(uint16_t x = 0; x < Bmp_Width_Byte; x++) {//Show a line in the line
-            if(fread((char *)&Rdata, 1, 1, fp) != 1) {
-                Debug("Read failed in %s\n", path);
-                fclose(fp);
-                return false;
-            }
-            if(x * 2 + xStart >= 0 && y + yStart >= 0 && x + xStart < bufWidthByte && x * 2 + xStart < bufWidth  && y + yStart < bufHeight) { //bmp
-                buffer[x + xStart + ((mirrorY ? y : info.height - y - 1) + yStart) * bufWidthByte] =  Rdata ^ invert;
-                // Debug("rdata = %d\r\n", Rdata);
-            }
-        }
-    }
-    fclose(fp);
-    return true;
-}
-
-
-/*************************************************************************
-
-Read a RGB (24-bit) bitmap from a .BMP file to a specified location in the display buffer.
-This does not actually update the display itself
-UNTESTED!!!!!
-Params: path -- path to file
-        buffer: buffer to read to (assumed to be 1 uint16 per pixel, containing
-        xStart, yStart: coordinates of the top-left corner of the image (may be negative)
-        bufWidth, bufHeight: Width & Height of display, for clipping
-        mirrorY: Invert the image in the Y axis
-
-*************************************************************************/
-bool BMPfile::readBmpRgb7Color(const char *path, uint16_t *buffer, int16_t xStart, int16_t yStart, uint16_t bufWidth, uint16_t bufHeight, bool invert, bool mirrorY) {
-    // Binary file open
-    FILE *fp;
-    if((fp = fopen(path, "rb")) == NULL) {
-        Debug("Can't open %s\n", path);
-        return false;
-    }
-
-    HEADER header;
-    INFO info;
-    // Set the file pointer from the beginning
-    fseek(fp, 0, SEEK_SET);
-    fread(&header, sizeof(header), 1, fp);    //sizeof(header) must be 14
-    fread(&info, sizeof(INFO), 1, fp);    //sizeof(header) must be 50
-    Debug("pixel = %d * %d\r\n", info.width, info.height);
-
-    // Determine if it is a monochrome bitmap
-    if(info.bitCount != 24) {
-        Debug("%s is not a 4-bit bitmap!\n", path);
-        return false;
-    }
-
-    // Read image data into the cache
-    uint8_t data[3];
-    fseek(fp, header.offset, SEEK_SET);
-
-    for(uint16_t y = 0; y < info.height; y++) {
-        for(uint16_t x = 0; x < info.width ; x++) {
-            if(fread((char *)data, 3, 1, fp) != 1) {
-                fclose(fp);
-                return false;
-                break;
-            }
-            uint16_t colour;
-            if(data[0] == 0 && data[1] == 0 && data[2] == 0) {
-                colour =  GxEPD_BLACK;
-            } else if(data[0] == 255 && data[1] == 255 && data[2] == 255) {
-                colour =  GxEPD_WHITE;
-            } else if(data[0] == 0 && data[1] == 255 && data[2] == 0) {
-                colour = GxEPD_GREEN;
-            } else if(data[0] == 255 && data[1] == 0 && data[2] == 0) {
-                colour =  GxEPD_BLUE;
-            } else if(data[0] == 0 && data[1] == 0 && data[2] == 255) {
-                colour =  GxEPD_RED;
-            } else if(data[0] == 0 && data[1] == 255 && data[2] == 255) {
-                colour =  GxEPD_YELLOW;
-            } else if(data[0] == 0 && data[1] == 128 && data[2] == 255) {
-                colour =  GxEPD_ORANGE;
-            }
-            if(x + xStart >= 0 && y + yStart >= 0 && x + xStart < bufWidth  && y + yStart < bufHeight)
-                buffer[x + xStart + ((mirrorY ? y : info.height - y - 1) + yStart) * bufWidth] =  colour;
-        }
-    }
-    fclose(fp);
-    return true;
-}
-
-
+        pos += (bytes + 1) & ~1u;
+    }
+    return _line;
+}
+
+// the rows of an image top to bottom, as palette indexes
+class BmpRowConverter {
+  public:
+    BmpRowConverter(const BMPfile::Image &image, const GxEPD2_Dither::Palette &palette, GxEPD2_Dither::Method dither, bool invert = false) :
+        _image(image), _dither(palette, dither, image.width()), _invert(invert) {
+        _rgb = new (std::nothrow) uint8_t[4 * image.width()];
+    };
+    ~BmpRowConverter() { delete[] _rgb; };
+    bool valid() const { return _rgb && _dither.valid(); };
+    // file row i; rows must be converted from the top of the image down
+    const uint8_t *convert(uint32_t i) {
+        uint32_t w = _image.width();
+        uint8_t *r = _rgb, *g = r + w, *b = g + w, *index = b + w;
+        _image.rgbRow(i, r, g, b);
+        if (_invert) {
+            for (uint32_t x = 0; x < 3 * w; x++) r[x] = ~r[x];
+        }
+        _dither.row(r, g, b, index);
+        return index;
+    };
+  private:
+    const BMPfile::Image &_image;
+    GxEPD2_Dither _dither;
+    bool _invert;
+    uint8_t *_rgb; // r, g, b and index rows
+};
+
+// one bit per pixel, msb first, set where index is not zero
+static void packRow(const uint8_t *index, uint32_t width, uint8_t zero, uint8_t *dst) {
+    for (uint32_t j = 0; j < (width + 7) / 8; j++) {
+        uint8_t v = 0;
+        for (uint8_t i = 0; i < 8; i++) {
+            uint32_t x = j * 8 + i;
+            v = (v << 1) | ((x < width) && (index[x] != zero));
+        }
+        dst[j] = v;
+    }
+}
+
+void BMPfile::Image::close() {
+    if (_data) {
+        if (_mapped) munmap(_data, _size);
+        else free(_data);
+    }
+    delete[] _rleStart;
+    delete[] _rleX;
+    delete[] _line;
+    _rleStart = 0;
+    _rleX = 0;
+    _line = 0;
+    _data = 0;
+    _size = 0;
+    _mapped = false;
+    _pixels = 0;
+    _pixelBytes = 0;
+    _topDown = _bitfields = false;
+    _width = _height = _stride = 0;
+    _bitCount = 0;
+}
+
+// combine n bytes of a bitmap row into a buffer row; one pass per row, simple enough for the compiler to vectorize
+static void rowOp(uint8_t *dst, const uint8_t *src, uint32_t n, GxEPD2_EPD::writeMode mode) {
+    switch (mode) {
+    case GxEPD2_EPD::OVERWRITE: memcpy(dst, src, n); break;
+    case GxEPD2_EPD::INVERT: for (uint32_t i = 0; i < n; i++) dst[i] = ~src[i]; break;
+    case GxEPD2_EPD::XOR: for (uint32_t i = 0; i < n; i++) dst[i] ^= src[i]; break;
+    case GxEPD2_EPD::INVERT_XOR: for (uint32_t i = 0; i < n; i++) dst[i] ^= ~src[i]; break;
+    }
+}
+
+/*************************************************************************
+
+Read a monochrome (single-bit) bitmap from a .BMP file to a specified location in the display buffer;
+gray and color bitmaps are dithered to black and white
+This does not actually update the display itself
+
+Params: path -- path to file
+        buffer: buffer to read to, 1 bit per pixel, bit 7 of byte = first bit
+        dispXBytes, dispY: position of the first byte of the first file row in the buffer (may be negative)
+        dispWidth, dispHeight: Width & Height of the buffer, for clipping
+        mode: how image bytes combine with the buffer
+        mirrorY: Invert the image in the Y axis
+        dither: how gray levels are shown, for bitmaps of more than one bit per pixel
+*************************************************************************/
+
+bool BMPfile::readBmpMono(const char *path, uint8_t *buffer, int16_t dispXBytes, int16_t dispY, uint16_t dispWidth, uint16_t dispHeight, GxEPD2_EPD::writeMode mode, bool mirrorY,
+                          GxEPD2_Dither::Method dither) {
+    Debug("readBmpMono %s, %d, %d, %d, %d\n", path, dispXBytes, dispY, dispWidth, dispHeight);
+    Image image;
+    if (!image.open(path)) return false;
+
+    // clip the columns once, whole rows are then copied
+    int32_t widthBytes = (image.width() + 7) >> 3;
+    int32_t dispWidthBytes = (dispWidth + 7) >> 3;
+    int32_t b0 = dispXBytes < 0 ? -dispXBytes : 0;
+    int32_t b1 = dispWidthBytes - dispXBytes < widthBytes ? dispWidthBytes - dispXBytes : widthBytes;
+    if (b0 >= b1) return true;
+    int32_t height = image.height();
+
+    // Monochrome bitmap: ignore palette, copy the rows
+    if (image.bitCount() == 1) {
+        for (int32_t y = 0; y < height; y++) {
+            int32_t row = dispY + (mirrorY ? height - y - 1 : y);
+            if ((row < 0) || (row >= dispHeight)) continue;
+            rowOp(buffer + row * dispWidthBytes + dispXBytes + b0, image.row(y) + b0, b1 - b0, mode);
+        }
+        return true;
+    }
+
+    // Gray or color: dither to black and white, from the top row of the image down
+    BmpRowConverter converter(image, GxEPD2_Dither::MONO, dither);
+    uint8_t *bits = new (std::nothrow) uint8_t[widthBytes];
+    if (!converter.valid() || !bits) {
+        delete[] bits;
+        return false;
+    }
+    for (int32_t y = height - 1; y >= 0; y--) {
+        int32_t row = dispY + (mirrorY ? height - y - 1 : y);
+        if ((row < 0) || (row >= dispHeight)) continue;
+        packRow(converter.convert(y), image.width(), 0, bits);
+        rowOp(buffer + row * dispWidthBytes + dispXBytes + b0, bits + b0, b1 - b0, mode);
+    }
+    delete[] bits;
+    return true;
+}
+
+/*************************************************************************
+
+Read a bitmap of any bit count from a .BMP file to the black and color buffers of a 3-color display
+This does not actually update the display itself
+
+Params: path -- path to file
+        black, color: buffers to read to, 1 bit per pixel, bit 7 of byte = first bit, 0 = black or color
+        dispXBytes, dispY, dispWidth, dispHeight, mirrorY: as for readBmpMono()
+        yellow: the color of the display is yellow, else red
+        dither: how colors of the image between the three colors are shown
+*************************************************************************/
+
+bool BMPfile::readBmp3Color(const char *path, uint8_t *black, uint8_t *color, int16_t dispXBytes, int16_t dispY, uint16_t dispWidth, uint16_t dispHeight, bool yellow, bool mirrorY,
+                            GxEPD2_Dither::Method dither) {
+    Image image;
+    if (!image.open(path)) return false;
+
+    int32_t widthBytes = (image.width() + 7) >> 3;
+    int32_t dispWidthBytes = (dispWidth + 7) >> 3;
+    int32_t b0 = dispXBytes < 0 ? -dispXBytes : 0;
+    int32_t b1 = dispWidthBytes - dispXBytes < widthBytes ? dispWidthBytes - dispXBytes : widthBytes;
+    if (b0 >= b1) return true;
+    int32_t height = image.height();
+
+    BmpRowConverter converter(image, yellow ? GxEPD2_Dither::BLACK_YELLOW : GxEPD2_Dither::BLACK_RED, dither);
+    uint8_t *bits = new (std::nothrow) uint8_t[2 * widthBytes];
+    if (!converter.valid() || !bits) {
+        delete[] bits;
+        return false;
+    }
+    for (int32_t y = height - 1; y >= 0; y--) {
+        int32_t row = dispY + (mirrorY ? height - y - 1 : y);
+        if ((row < 0) || (row >= dispHeight)) continue;
+        const uint8_t *index = converter.convert(y);
+        // palette indexes 0 black, 1 white, 2 color
+        packRow(index, image.width(), 0, bits);
+        packRow(index, image.width(), 2, bits + widthBytes);
+        memcpy(black + row * dispWidthBytes + dispXBytes + b0, bits + b0, b1 - b0);
+        memcpy(color + row * dispWidthBytes + dispXBytes + b0, bits + widthBytes + b0, b1 - b0);
+    }
+    delete[] bits;
+    return true;
+}
+
+/*************************************************************************
+
+Read a gray-scale (4-bit) bitmap from a .BMP file to a specified location in the display buffer.
+This does not actually update the display itself
+UNTESTED!!!!!
+Params: path -- path to file
+        buffer: buffer to read to (assumed to be the same format as the bitmap -- bits 7..4 of byte = first pixel
+        xStart, yStart: coordinates of the top-left corner of the image (may be negative), xStart should be even
+        bufWidth, bufHeight: Width & Height of display, for clipping
+        invert: Invert image colours (0xff = invert, 0x00 = don't change)
+        mirrorY: Invert the image in the Y axis
+
+*************************************************************************/
+bool BMPfile::readBmp4Gray(const char *path, uint8_t *buffer, int16_t xStart, int16_t yStart, uint16_t bufWidth, uint16_t bufHeight, uint8_t invert, bool mirrorY) {
+    Image image;
+    if (!image.open(path)) return false;
+    Debug("pixel = %d * %d\r\n", image.width(), image.height());
+
+    // Determine if it is a 4-bit bitmap
+    if (image.bitCount() != 4) {
+        Debug("%s is not a 4-bit bitmap!\n", path);
+        return false;
+    }
+
+    int32_t widthBytes = (image.width() + 1) / 2;
+    int32_t bufWidthByte = (bufWidth + 1) / 2;
+    int32_t xByte = xStart >> 1;
+    int32_t b0 = xByte < 0 ? -xByte : 0;
+    int32_t b1 = bufWidthByte - xByte < widthBytes ? bufWidthByte - xByte : widthBytes;
+    if (b0 >= b1) return true;
+    int32_t height = image.height();
+    for (int32_t y = 0; y < height; y++) {
+        int32_t row = yStart + (mirrorY ? y : height - y - 1);
+        if ((row < 0) || (row >= bufHeight)) continue;
+        uint8_t *dst = buffer + row * bufWidthByte + xByte;
+        const uint8_t *src = image.row(y);
+        for (int32_t x = b0; x < b1; x++) dst[x] = src[x] ^ invert;
+    }
+    return true;
+}
+
+
+/*************************************************************************
+
+Read a bitmap of any bit count from a .BMP file to a specified location in the display buffer,
+in the seven colors of GxEPD2_565c.
+This does not actually update the display itself
+Params: path -- path to file
+        buffer: buffer to read to (assumed to be 1 uint16 per pixel, containing GxEPD_BLACK etc.)
+        xStart, yStart: coordinates of the top-left corner of the image (may be negative)
+        bufWidth, bufHeight: Width & Height of display, for clipping
+        invert: Invert image colours
+        mirrorY: Invert the image in the Y axis
+        dither: how colors of the image between the seven colors are shown
+
+*************************************************************************/
+bool BMPfile::readBmpRgb7Color(const char *path, uint16_t *buffer, int16_t xStart, int16_t yStart, uint16_t bufWidth, uint16_t bufHeight, bool invert, bool mirrorY,
+                               GxEPD2_Dither::Method dither) {
+    Image image;
+    if (!image.open(path)) return false;
+    Debug("pixel = %d * %d\r\n", image.width(), image.height());
+
+    int32_t x0 = xStart < 0 ? -xStart : 0;
+    int32_t x1 = int32_t(bufWidth) - xStart < int32_t(image.width()) ? int32_t(bufWidth) - xStart : int32_t(image.width());
+    if (x0 >= x1) return true;
+    int32_t height = image.height();
+
+    // every color maps to the nearest of the seven, the exact seven to themselves
+    const GxEPD2_Dither::Palette &palette = GxEPD2_Dither::SEVEN_COLOR;
+    BmpRowConverter converter(image, palette, dither, invert);
+    if (!converter.valid()) return false;
+    for (int32_t y = height - 1; y >= 0; y--) {
+        int32_t row = yStart + (mirrorY ? y : height - y - 1);
+        if ((row < 0) || (row >= bufHeight)) continue;
+        uint16_t *dst = buffer + row * bufWidth + xStart;
+        const uint8_t *index = converter.convert(y);
+        for (int32_t x = x0; x < x1; x++) dst[x] = palette.color[index[x]];
+    }
+    return true;
+}
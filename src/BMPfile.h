@@ -44,13 +44,66 @@
 #define __GUI_BMPFILE_H
 
 #include <stdint.h>
-#include "GxEPD2_EPD.h"
+#include <stddef.h>
+#include "GxEPD2_EPD.h"
+#include "GxEPD2_Dither.h"
 class BMPfile
 {
   public:
-static bool readBmpMono(const char *path, uint8_t *buffer, int16_t dispXBytes, int16_t dispY, uint16_t dispWidth, uint16_t dispHeight, GxEPD2_EPD::writeMode mode, bool mirrorY);
+    // A BMP file, mapped into memory (or read in one block if it can't be mapped).
+    // The headers are checked once by open(). Row 0 is the bottom row of the image, also for top-down files.
+    // RLE8 and RLE4 rows are decoded by row() into a row buffer, valid until the next row().
+    class Image
+    {
+      public:
+        Image() : _data(0), _size(0), _mapped(false), _pixels(0), _pixelBytes(0), _palette(0), _colours(0), _width(0), _height(0), _bitCount(0), _stride(0),
+          _topDown(false), _bitfields(false), _rleStart(0), _rleX(0), _line(0) {};
+        ~Image() { close(); };
+        bool open(const char *path);
+        void close();
+        uint32_t width() const { return _width; };
+        uint32_t height() const { return _height; };
+        uint16_t bitCount() const { return _bitCount; };
+        // bytes of a row, padded to 4
+        uint32_t stride() const { return _stride; };
+        // rows are not in the file as they are, see row()
+        bool compressed() const { return _rleStart != 0; };
+        bool topDown() const { return _topDown; };
+        const uint8_t* row(uint32_t i) const { return _rleStart ? _decode(i) : _pixels + (_topDown ? _height - 1 - i : i) * _stride; };
+        // color table of 1, 4 and 8 bit images, blue, green, red, reserved for each color
+        const uint8_t* palette() const { return _palette; };
+        uint32_t colours() const { return _colours; };
+        // row i as 8 bit red, green and blue, of any bit count
+        void rgbRow(uint32_t i, uint8_t *r, uint8_t *g, uint8_t *b) const;
+      private:
+        Image(const Image&);
+        Image& operator=(const Image&);
+        bool _indexRle(uint8_t bits);
+        const uint8_t* _decode(uint32_t i) const;
+        uint8_t *_data;
+        size_t _size;
+        bool _mapped;
+        const uint8_t *_pixels;
+        size_t _pixelBytes;
+        const uint8_t *_palette;
+        uint32_t _colours;
+        uint32_t _width, _height;
+        uint16_t _bitCount;
+        uint32_t _stride;
+        bool _topDown, _bitfields;
+        uint32_t _mask[3]; // red, green and blue of 16 and 32 bit rows
+        uint8_t _shift[3], _bits[3];
+        uint32_t *_rleStart; // offset of the first code of each row, UINT32_MAX for rows with no pixels
+        uint32_t *_rleX; // x of the first pixel of that code
+        uint8_t *_line; // row buffer for RLE rows
+    };
+static bool readBmpMono(const char *path, uint8_t *buffer, int16_t dispXBytes, int16_t dispY, uint16_t dispWidth, uint16_t dispHeight, GxEPD2_EPD::writeMode mode, bool mirrorY,
+                        GxEPD2_Dither::Method dither = GxEPD2_Dither::FLOYD_STEINBERG);
+static bool readBmp3Color(const char *path, uint8_t *black, uint8_t *color, int16_t dispXBytes, int16_t dispY, uint16_t dispWidth, uint16_t dispHeight, bool yellow = false, bool mirrorY = false,
+                          GxEPD2_Dither::Method dither = GxEPD2_Dither::FLOYD_STEINBERG);
 static bool readBmp4Gray(const char *path, uint8_t *buffer, int16_t xStart, int16_t yStart, uint16_t bufWidth, uint16_t bufHeight, uint8_t invert = 0, bool mirrorY = false);
-static bool readBmpRgb7Color(const char *path, uint16_t *buffer, int16_t xStart, int16_t yStart, uint16_t bufWidth, uint16_t bufHeight, bool invert = false, bool mirrorY = false);
+static bool readBmpRgb7Color(const char *path, uint16_t *buffer, int16_t xStart, int16_t yStart, uint16_t bufWidth, uint16_t bufHeight, bool invert = false, bool mirrorY = false,
+                             GxEPD2_Dither::Method dither = GxEPD2_Dither::FLOYD_STEINBERG);
 };
 
 #endif
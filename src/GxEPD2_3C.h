@@ -30,6 +30,9 @@
 #endif
 
 #include "GxEPD2_EPD.h"
+#include "GxEPD2_DirtyRegion.h"
+#include "GxEPD2_Transform.h"
+#include "GxEPD2_Blit.h"
 #ifdef RPI
 #include "BMPfile.h"
 #endif // RPI
@@ -60,14 +63,25 @@ RPI_SPI SPI;
     GxEPD2_3C(GxEPD2_Type epd2_instance) : GxEPD2_GFX_BASE_CLASS(GxEPD2_Type::WIDTH, GxEPD2_Type::HEIGHT), epd2(epd2_instance)
 #endif
     {
-      _page_height = page_height;
-      _pages = (HEIGHT / _page_height) + ((HEIGHT % _page_height) > 0);
       _mirror = false;
       _using_partial_mode = false;
       _current_page = 0;
+      _buffer_allocated = false;
+      _useBuffer(_page_buffer, sizeof(_page_buffer));
+      if (page_height > 0) _setPageHeight(page_height);
+      else if (!allocateBuffer()) _setPageHeight(1); // page_height 0: heap buffer, full frame if memory allows
       setFullWindow();
     }
 
+    ~GxEPD2_3C()
+    {
+      if (_buffer_allocated) free(_black_buffer);
+    }
+
+    // owns its buffer, not copyable
+    GxEPD2_3C(const GxEPD2_3C&) = delete;
+    GxEPD2_3C& operator=(const GxEPD2_3C&) = delete;
+
     uint16_t pages()
     {
       return _pages;
@@ -78,47 +92,66 @@ RPI_SPI SPI;
       return _page_height;
     }
 
+    // page height within the buffer size, e.g. HEIGHT for full frame or fewer rows for paged drawing; buffer content is lost
+    bool setPageHeight(uint16_t rows)
+    {
+      rows = gx_uint16_min(rows, HEIGHT);
+      if ((rows == 0) || (uint32_t(WIDTH / 8) * rows > _plane_size)) return false;
+      _setPageHeight(rows);
+      return true;
+    }
+
+    // buffer from the heap instead of the buffer in the object, for a page height of rows;
+    // page height is halved until allocation succeeds; returns the page height, 0 if no buffer could be allocated
+    uint16_t allocateBuffer(uint16_t rows = GxEPD2_Type::HEIGHT)
+    {
+      for (uint16_t h = gx_uint16_min(rows, HEIGHT); h > 0; h /= 2)
+      {
+        uint8_t* buffer = (uint8_t*)malloc(2 * uint32_t(WIDTH / 8) * h);
+        if (!buffer) continue;
+        _setBuffer(buffer, 2 * uint32_t(WIDTH / 8) * h, true);
+        return h;
+      }
+      return 0;
+    }
+
+    // buffer given by the caller, e.g. from a mmap'd region, used until changed; 0 selects the buffer in the object again.
+    // the black and the color plane take half of it each; page height is as many rows as fit, at most HEIGHT;
+    // returns false if not a single row fits
+    bool setBuffer(uint8_t* buffer, uint32_t size)
+    {
+      if (!buffer) return _setBuffer(_page_buffer, sizeof(_page_buffer), false);
+      return _setBuffer(buffer, size, false);
+    }
+
+    uint32_t bufferSize()
+    {
+      return 2 * _plane_size;
+    }
+
     bool mirror(bool m)
     {
       _swap_ (_mirror, m);
+      _transform.invalidate();
       return m;
     }
 
     void drawPixel(int16_t x, int16_t y, uint16_t color)
     {
-      if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
-      if (_mirror) x = width() - x - 1;
-      // check rotation, move pixel around if necessary
-      switch (getRotation())
-      {
-        case 1:
-          _swap_(x, y);
-          x = WIDTH - x - 1;
-          break;
-        case 2:
-          x = WIDTH - x - 1;
-          y = HEIGHT - y - 1;
-          break;
-        case 3:
-          _swap_(x, y);
-          y = HEIGHT - y - 1;
-          break;
-      }
-      // transpose partial window to 0,0
-      x -= _pw_x;
-      y -= _pw_y;
-      // clip to (partial) window
-      if ((x < 0) || (x >= _pw_w) || (y < 0) || (y >= _pw_h)) return;
-      // adjust for current page
-      y -= _current_page * _page_height;
-      // check if in current page
-      if ((y < 0) || (y >= _page_height)) return;
-      uint16_t i = x / 8 + y * (_pw_w / 8);
-      _black_buffer[i] = (_black_buffer[i] | (1 << (7 - x % 8))); // white
-      _color_buffer[i] = (_color_buffer[i] | (1 << (7 - x % 8)));
-      if (color == GxEPD_WHITE) return;
-      else if (color == GxEPD_BLACK) _black_buffer[i] = (_black_buffer[i] & (0xFF ^ (1 << (7 - x % 8))));
-      else if ((color == GxEPD_RED) || (color == GxEPD_YELLOW)) _color_buffer[i] = (_color_buffer[i] & (0xFF ^ (1 << (7 - x % 8))));
+      // mirror, rotation, window and page are precomputed in _transform
+      if (!_transform.valid(getRotation(), _current_page))
+        _transform.set(getRotation(), _mirror, width(), height(), WIDTH, HEIGHT, _pw_x, _pw_y, _pw_w, _pw_h, _current_page, _page_height);
+      if (!_transform.contains(x, y)) return;
+      uint32_t p = _transform.index(x, y);
+      uint32_t i = p / 8;
+      uint8_t bit = 1 << (7 - p % 8);
+      uint8_t old_black = _black_buffer[i], old_color = _color_buffer[i];
+      _black_buffer[i] = (_black_buffer[i] | bit); // white
+      _color_buffer[i] = (_color_buffer[i] | bit);
+      if (color == GxEPD_WHITE);
+      else if (color == GxEPD_BLACK) _black_buffer[i] = (_black_buffer[i] & (0xFF ^ bit));
+      else if ((color == GxEPD_RED) || (color == GxEPD_YELLOW)) _color_buffer[i] = (_color_buffer[i] & (0xFF ^ bit));
+      if ((_black_buffer[i] != old_black) || (_color_buffer[i] != old_color)) _dirty.add(_transform.panelX(x, y), _transform.panelY(x, y));
     }
 
     bool init(uint32_t serial_diag_bitrate = 0) // = 0 : disabled
@@ -127,6 +160,7 @@ RPI_SPI SPI;
       _using_partial_mode = false;
       _current_page = 0;
       setFullWindow();
+      _dirty.clear();
       return 1;
     }
 
@@ -141,6 +175,7 @@ RPI_SPI SPI;
       _using_partial_mode = false;
       _current_page = 0;
       setFullWindow();
+      _dirty.clear();
     }
 
     void fillScreen(uint16_t color) // 0x0 black, >0x0 white, to buffer
@@ -150,11 +185,17 @@ RPI_SPI SPI;
       if (color == GxEPD_WHITE);
       else if (color == GxEPD_BLACK) black = 0x00;
       else if ((color == GxEPD_RED) || (color == GxEPD_YELLOW)) red = 0x00;
-      for (uint16_t x = 0; x < sizeof(_black_buffer); x++)
+      int32_t first = -1, last = -1;
+      uint32_t page_bytes = uint32_t(WIDTH / 8) * _page_height;
+      for (uint32_t x = 0; x < page_bytes; x++)
       {
+        if ((_black_buffer[x] == black) && (_color_buffer[x] == red)) continue;
+        if (first < 0) first = x;
+        last = x;
         _black_buffer[x] = black;
         _color_buffer[x] = red;
       }
+      if (first >= 0) _markDirtyRows(first / (_pw_w / 8), last / (_pw_w / 8));
     }
 
     // display buffer content to screen, useful for full screen buffer
@@ -163,7 +204,40 @@ RPI_SPI SPI;
       epd2.writeImage(_black_buffer, _color_buffer, 0, 0, WIDTH, _page_height);
       epd2.refresh(partial_update_mode);
       if (!partial_update_mode) epd2.powerOff();
+      _dirty.clear();
+    }
+
+    // display the parts of the buffer changed since the last display, with partial refresh; for full screen buffer.
+    // changed parts are tracked by drawPixel() and fillScreen(); all parts are written, then refreshed as one window
+    void displayChanged()
+    {
+      if (_dirty.empty()) return;
+      for (uint8_t i = 0; i < _dirty.count(); i++)
+      {
+        GxEPD2_DirtyRegion::Box b = _dirty.box(i);
+        epd2.writeImagePart(_black_buffer, _color_buffer, b.x, b.y, WIDTH, _page_height, b.x, b.y, b.w, b.h);
+      }
+      GxEPD2_DirtyRegion::Box b = _dirty.bounds();
+      epd2.refresh(b.x, b.y, b.w, b.h);
+      _dirty.clear();
+    }
+
+    // number of changed parts displayChanged() would write, 0 if nothing changed
+    uint8_t changedParts()
+    {
+      return _dirty.count();
+    }
+
+#ifdef RPI
+    // as display(), but returns once the buffer is written to the controller, the buffer can be drawn to at once;
+    // refresh and power off continue in the background, see GxEPD2_EPD::refreshAsync()
+    std::shared_future<void> displayAsync(bool partial_update_mode = false, std::function<void()> done = nullptr)
+    {
+      epd2.writeImage(_black_buffer, _color_buffer, 0, 0, WIDTH, _page_height);
+      _dirty.clear();
+      return refreshAsync(partial_update_mode, done);
     }
+#endif
 
     // display part of buffer content to screen, useful for full screen buffer
     // displayWindow, use parameters according to actual rotation.
@@ -201,6 +275,7 @@ RPI_SPI SPI;
       _pw_y = 0;
       _pw_w = WIDTH;
       _pw_h = HEIGHT;
+      _transform.invalidate();
     }
 
     // setPartialWindow, use parameters according to actual rotation.
@@ -221,6 +296,7 @@ RPI_SPI SPI;
       _pw_w += _pw_x % 8;
       if (_pw_w % 8 > 0) _pw_w += 8 - _pw_w % 8;
       _pw_x -= _pw_x % 8;
+      _transform.invalidate();
     }
 
     void firstPage()
@@ -422,30 +498,22 @@ RPI_SPI SPI;
       _current_page = 0;
     }
 
+    // drawBitmap() of GFX, but blitted by whole bytes; set bits are drawn in color
+    void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color)
+    {
+      _drawBitmap(x, y, bitmap, w, h, GxEPD2_Blit::foreground(_blackBit(color)), GxEPD2_Blit::foreground(_colorBit(color)));
+    }
+
+    // set bits are drawn in color, unset bits in bg
+    void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, uint16_t bg)
+    {
+      _drawBitmap(x, y, bitmap, w, h, GxEPD2_Blit::opaque(_blackBit(color), _blackBit(bg)), GxEPD2_Blit::opaque(_colorBit(color), _colorBit(bg)));
+    }
+
+    // unset bits are drawn in color
     void drawInvertedBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color)
     {
-      // taken from Adafruit_GFX.cpp, modified
-      int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
-      uint8_t byte = 0;
-      for (int16_t j = 0; j < h; j++)
-      {
-        for (int16_t i = 0; i < w; i++ )
-        {
-          if (i & 7) byte <<= 1;
-          else
-          {
-#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
-            byte = pgm_read_byte(&bitmap[j * byteWidth + i / 8]);
-#else
-            byte = bitmap[j * byteWidth + i / 8];
-#endif
-          }
-          if (!(byte & 0x80))
-          {
-            drawPixel(x + i, y + j, color);
-          }
-        }
-      }
+      _drawBitmap(x, y, bitmap, w, h, GxEPD2_Blit::background(_blackBit(color)), GxEPD2_Blit::background(_colorBit(color)));
     }
 
     //  Support for Bitmaps (Sprites) to Controller Buffer and to Screen
@@ -481,9 +549,26 @@ RPI_SPI SPI;
       epd2.writeImagePart(black, color, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h, invert, mirror_y, pgm);
     }
 
-    bool writeBmpFile(const char *path, int16_t x, int16_t y, const uint16_t colour, BMPfile::readMode mode = BMPfile::OVERWRITE, bool mirror_y = false) {
-        return BMPfile::readBmpMono(path, colour == GxEPD_BLACK || colour == GxEPD_WHITE ? _black_buffer : _color_buffer, x, y, WIDTH, HEIGHT, mode, mirror_y);
+#ifdef RPI
+    // BMP file of any bit count to the black and color buffers, dithered to black, white and the panel color, yellow or red;
+    // x should be a multiple of 8
+    bool writeBmpFile(const char *path, int16_t x, int16_t y, bool yellow = false, bool mirror_y = false,
+                      GxEPD2_Dither::Method dither = GxEPD2_Dither::FLOYD_STEINBERG)
+    {
+      BMPfile::Image image;
+      if (!image.open(path)) return false;
+      int32_t w = (image.width() + 7) & ~7, h = image.height(); // rows are written by whole bytes
+      image.close();
+      if (!BMPfile::readBmp3Color(path, _black_buffer, _color_buffer, x / 8, y, WIDTH, _page_height, yellow, mirror_y, dither)) return false;
+      // the image rectangle, clipped to the buffer
+      int32_t x0 = (x / 8) * 8, y0 = y;
+      int32_t x1 = x0 + w < WIDTH ? x0 + w : WIDTH, y1 = y0 + h < _page_height ? y0 + h : _page_height;
+      if (x0 < 0) x0 = 0;
+      if (y0 < 0) y0 = 0;
+      if ((x1 > x0) && (y1 > y0)) _dirty.add(x0, y0, x1 - x0, y1 - y0);
+      return true;
     }
+#endif
 
     void writeImagePart(const uint8_t* black, const uint8_t* color, int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
                         int16_t x, int16_t y, int16_t w, int16_t h)
@@ -537,6 +622,22 @@ RPI_SPI SPI;
     {
       epd2.refresh(x, y, w, h);
     }
+#ifdef RPI
+    // as refresh(), but returns at once, see GxEPD2_EPD::refreshAsync()
+    std::shared_future<void> refreshAsync(bool partial_update_mode = false, std::function<void()> done = nullptr)
+    {
+      GxEPD2_Type* epd = &epd2;
+      return epd2.runAsync([epd, partial_update_mode]()
+      {
+        epd->refresh(partial_update_mode);
+        if (!partial_update_mode) epd->powerOff();
+      }, done);
+    }
+    std::shared_future<void> refreshAsync(int16_t x, int16_t y, int16_t w, int16_t h, std::function<void()> done = nullptr)
+    {
+      return epd2.refreshAsync(x, y, w, h, done);
+    }
+#endif
     // turns off generation of panel driving voltages, avoids screen fading over time
     void powerOff()
     {
@@ -583,10 +684,116 @@ RPI_SPI SPI;
           break;
       }
     }
+    // buffer bits of a color as drawPixel() sets them
+    static uint8_t _blackBit(uint16_t color)
+    {
+      return color != GxEPD_BLACK;
+    }
+    static uint8_t _colorBit(uint16_t color)
+    {
+      return (color != GxEPD_RED) && (color != GxEPD_YELLOW);
+    }
+    // mirror and rotation are applied once per bitmap, rotation 1 and 3 blit the transposed bitmap
+    void _drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, const GxEPD2_Blit::Pen& black, const GxEPD2_Blit::Pen& color)
+    {
+      if ((w <= 0) || (h <= 0)) return;
+      bool flip = _mirror;
+      if (_mirror) x = width() - x - w;
+      uint8_t rotation = getRotation();
+      const uint8_t* src = bitmap;
+      uint8_t* t = 0;
+      uint16_t row_bytes = (w + 7) / 8, bits = w, rows = h;
+      int32_t px = x, py = y;
+      bool reverse_bits = flip, reverse_rows = false;
+      if (rotation == 2)
+      {
+        px = int32_t(WIDTH) - x - w;
+        py = int32_t(HEIGHT) - y - h;
+        reverse_bits = !flip;
+        reverse_rows = true;
+      }
+      else if ((rotation == 1) || (rotation == 3))
+      {
+        src = t = GxEPD2_Blit::transpose(bitmap, w, h);
+        if (!t) return;
+        row_bytes = (h + 7) / 8;
+        bits = h;
+        rows = w;
+        px = rotation == 1 ? int32_t(WIDTH) - y - h : y;
+        py = rotation == 1 ? x : int32_t(HEIGHT) - x - w;
+        reverse_bits = rotation == 1;
+        reverse_rows = rotation == 1 ? flip : !flip;
+      }
+      _blit(_black_buffer, src, row_bytes, bits, rows, px, py, reverse_bits, reverse_rows, black);
+      _blit(_color_buffer, src, row_bytes, bits, rows, px, py, reverse_bits, reverse_rows, color);
+      free(t);
+    }
+    // bitmap rows to panel rows py.., or reversed; bits to panel x px.., or reversed; clipped to (partial) window and page
+    void _blit(uint8_t* buffer, const uint8_t* src, uint16_t row_bytes, uint16_t bits, uint16_t rows, int32_t px, int32_t py, bool reverse_bits, bool reverse_rows,
+               const GxEPD2_Blit::Pen& pen)
+    {
+      int32_t xa = px > _pw_x ? px : _pw_x;
+      int32_t xb = px + bits < _pw_x + _pw_w ? px + bits : _pw_x + _pw_w;
+      if (xa >= xb) return;
+      int32_t page_ys = int32_t(_current_page) * _page_height;
+      int32_t dirty_y0 = -1, dirty_y1 = -1;
+      for (uint16_t r = 0; r < rows; r++)
+      {
+        int32_t panel_y = py + (reverse_rows ? rows - 1 - r : r);
+        int32_t y = panel_y - _pw_y;
+        if ((y < 0) || (y >= _pw_h)) continue;
+        y -= page_ys;
+        if ((y < 0) || (y >= _page_height)) continue;
+        if (!GxEPD2_Blit::row(buffer + y * (_pw_w / 8), _pw_x, src + uint32_t(r) * row_bytes, row_bytes, bits, px, reverse_bits, xa, xb, pen, GxEPD2_EPD::OVERWRITE)) continue;
+        if ((dirty_y0 < 0) || (panel_y < dirty_y0)) dirty_y0 = panel_y;
+        if (panel_y + 1 > dirty_y1) dirty_y1 = panel_y + 1;
+      }
+      if (dirty_y0 >= 0) _dirty.add(xa, dirty_y0, xb - xa, dirty_y1 - dirty_y0);
+    }
+    // buffer rows first..last, of the current page and (partial) window, were changed
+    void _markDirtyRows(uint16_t first, uint16_t last)
+    {
+      uint16_t y0 = _pw_y + _current_page * _page_height + first;
+      uint16_t y1 = gx_uint16_min(_pw_y + _current_page * _page_height + last + 1, _pw_y + _pw_h);
+      if (y1 > y0) _dirty.add(_pw_x, y0, _pw_w, y1 - y0);
+    }
+    void _setPageHeight(uint16_t rows)
+    {
+      _page_height = rows;
+      _transform.invalidate();
+      _pages = (HEIGHT / _page_height) + ((HEIGHT % _page_height) > 0);
+      _current_page = 0;
+      _dirty.clear();
+    }
+    void _useBuffer(uint8_t* buffer, uint32_t size)
+    {
+      _plane_size = size / 2;
+      _black_buffer = buffer;
+      _color_buffer = buffer + _plane_size;
+    }
+    bool _setBuffer(uint8_t* buffer, uint32_t size, bool allocated)
+    {
+      if (size / 2 < uint32_t(WIDTH / 8))
+      {
+        if (allocated) free(buffer);
+        return false;
+      }
+      if (_buffer_allocated) free(_black_buffer);
+      _useBuffer(buffer, size);
+      _buffer_allocated = allocated;
+      _setPageHeight(gx_uint16_min(_plane_size / (WIDTH / 8), HEIGHT));
+      return true;
+    }
 
   private:
-    uint8_t _black_buffer[(GxEPD2_Type::WIDTH / 8) * page_height];
-    uint8_t _color_buffer[(GxEPD2_Type::WIDTH / 8) * page_height];
+    // black plane, then color plane; page_height 0: one row, the buffer is allocated at run time
+    uint8_t _page_buffer[2 * (GxEPD2_Type::WIDTH / 8) * (page_height > 0 ? page_height : 1)];
+    uint8_t* _black_buffer; // in _page_buffer, or in an allocated or given buffer
+    uint8_t* _color_buffer;
+    uint32_t _plane_size;
+    bool _buffer_allocated;
+    GxEPD2_DirtyRegion _dirty;
+    GxEPD2_Transform _transform;
     bool _using_partial_mode, _second_phase, _mirror;
     uint16_t _width_bytes, _pixel_bytes;
     int16_t _current_page;
@@ -30,6 +30,8 @@
 #endif
 
 #include "GxEPD2_EPD.h"
+#include "GxEPD2_DirtyRegion.h"
+#include "GxEPD2_Transform.h"
 #ifdef RPI
 #include "BMPfile.h"
 #endif // RPI
@@ -46,14 +48,27 @@ class GxEPD2_7C : public GxEPD2_GFX_BASE_CLASS
     GxEPD2_7C(GxEPD2_Type epd2_instance) : GxEPD2_GFX_BASE_CLASS(GxEPD2_Type::WIDTH, GxEPD2_Type::HEIGHT), epd2(epd2_instance)
 #endif
     {
-      _page_height = page_height;
-      _pages = (HEIGHT / _page_height) + ((HEIGHT % _page_height) > 0);
       _mirror = false;
       _using_partial_mode = false;
       _current_page = 0;
+      _dirty = GxEPD2_DirtyRegion(2); // as setPartialWindow()
+      _pixel_buffer = _page_buffer;
+      _buffer_size = sizeof(_page_buffer);
+      _buffer_allocated = false;
+      if (page_height > 0) _setPageHeight(page_height);
+      else if (!allocateBuffer()) _setPageHeight(1); // page_height 0: heap buffer, full frame if memory allows
       setFullWindow();
     }
 
+    ~GxEPD2_7C()
+    {
+      if (_buffer_allocated) free(_pixel_buffer);
+    }
+
+    // owns its buffer, not copyable
+    GxEPD2_7C(const GxEPD2_7C&) = delete;
+    GxEPD2_7C& operator=(const GxEPD2_7C&) = delete;
+
     uint16_t pages()
     {
       return _pages;
@@ -64,45 +79,62 @@ class GxEPD2_7C : public GxEPD2_GFX_BASE_CLASS
       return _page_height;
     }
 
+    // page height within the buffer size, e.g. HEIGHT for full frame or fewer rows for paged drawing; buffer content is lost
+    bool setPageHeight(uint16_t rows)
+    {
+      rows = gx_uint16_min(rows, HEIGHT);
+      if ((rows == 0) || (uint32_t(WIDTH / 2) * rows > _buffer_size)) return false;
+      _setPageHeight(rows);
+      return true;
+    }
+
+    // buffer from the heap instead of the buffer in the object, for a page height of rows;
+    // page height is halved until allocation succeeds; returns the page height, 0 if no buffer could be allocated
+    uint16_t allocateBuffer(uint16_t rows = GxEPD2_Type::HEIGHT)
+    {
+      for (uint16_t h = gx_uint16_min(rows, HEIGHT); h > 0; h /= 2)
+      {
+        uint8_t* buffer = (uint8_t*)malloc(uint32_t(WIDTH / 2) * h);
+        if (!buffer) continue;
+        _setBuffer(buffer, uint32_t(WIDTH / 2) * h, true);
+        return h;
+      }
+      return 0;
+    }
+
+    // buffer given by the caller, e.g. from a mmap'd region, used until changed; 0 selects the buffer in the object again.
+    // page height is as many rows as fit, at most HEIGHT; returns false if not a single row fits
+    bool setBuffer(uint8_t* buffer, uint32_t size)
+    {
+      if (!buffer) return _setBuffer(_page_buffer, sizeof(_page_buffer), false);
+      return _setBuffer(buffer, size, false);
+    }
+
+    uint32_t bufferSize()
+    {
+      return _buffer_size;
+    }
+
     bool mirror(bool m)
     {
       _swap_ (_mirror, m);
+      _transform.invalidate();
       return m;
     }
 
     void drawPixel(int16_t x, int16_t y, uint16_t color)
     {
-      if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
-      if (_mirror) x = width() - x - 1;
-      // check rotation, move pixel around if necessary
-      switch (getRotation())
-      {
-        case 1:
-          _swap_(x, y);
-          x = WIDTH - x - 1;
-          break;
-        case 2:
-          x = WIDTH - x - 1;
-          y = HEIGHT - y - 1;
-          break;
-        case 3:
-          _swap_(x, y);
-          y = HEIGHT - y - 1;
-          break;
-      }
-      // transpose partial window to 0,0
-      x -= _pw_x;
-      y -= _pw_y;
-      // clip to (partial) window
-      if ((x < 0) || (x >= _pw_w) || (y < 0) || (y >= _pw_h)) return;
-      // adjust for current page
-      y -= _current_page * _page_height;
-      // check if in current page
-      if ((y < 0) || (y >= _page_height)) return;
-      uint32_t i = x / 2 + uint32_t(y) * (_pw_w / 2);
+      // mirror, rotation, window and page are precomputed in _transform
+      if (!_transform.valid(getRotation(), _current_page))
+        _transform.set(getRotation(), _mirror, width(), height(), WIDTH, HEIGHT, _pw_x, _pw_y, _pw_w, _pw_h, _current_page, _page_height);
+      if (!_transform.contains(x, y)) return;
+      uint32_t p = _transform.index(x, y);
+      uint32_t i = p / 2;
       uint8_t pv = color7(color);
-      if (x & 1) _pixel_buffer[i] = (_pixel_buffer[i] & 0xF0) | pv;
+      uint8_t old = _pixel_buffer[i];
+      if (p & 1) _pixel_buffer[i] = (_pixel_buffer[i] & 0xF0) | pv;
       else _pixel_buffer[i] = (_pixel_buffer[i] & 0x0F) | (pv << 4);
+      if (_pixel_buffer[i] != old) _dirty.add(_transform.panelX(x, y), _transform.panelY(x, y));
     }
 
     void init(uint32_t serial_diag_bitrate = 0) // = 0 : disabled
@@ -111,6 +143,7 @@ class GxEPD2_7C : public GxEPD2_GFX_BASE_CLASS
       _using_partial_mode = false;
       _current_page = 0;
       setFullWindow();
+      _dirty.clear();
     }
 
     // init method with additional parameters:
@@ -124,16 +157,23 @@ class GxEPD2_7C : public GxEPD2_GFX_BASE_CLASS
       _using_partial_mode = false;
       _current_page = 0;
       setFullWindow();
+      _dirty.clear();
     }
 
     void fillScreen(uint16_t color)
     {
       uint8_t pv = color7(color);
       uint8_t pv2 = pv | pv << 4;
-      for (uint32_t x = 0; x < sizeof(_pixel_buffer); x++)
+      int32_t first = -1, last = -1;
+      uint32_t page_bytes = uint32_t(WIDTH / 2) * _page_height;
+      for (uint32_t x = 0; x < page_bytes; x++)
       {
+        if (_pixel_buffer[x] == pv2) continue;
+        if (first < 0) first = x;
+        last = x;
         _pixel_buffer[x] = pv2;
       }
+      if (first >= 0) _markDirtyRows(first / (_pw_w / 2), last / (_pw_w / 2));
     }
 
     // display buffer content to screen, useful for full screen buffer
@@ -142,8 +182,41 @@ class GxEPD2_7C : public GxEPD2_GFX_BASE_CLASS
       epd2.writeNative(_pixel_buffer, 0, 0, 0, WIDTH, _page_height);
       epd2.refresh(partial_update_mode);
       if (!partial_update_mode) epd2.powerOff();
+      _dirty.clear();
     }
 
+    // display the parts of the buffer changed since the last display, with partial refresh; for full screen buffer.
+    // changed parts are tracked by drawPixel() and fillScreen(); all parts are written, then refreshed as one window
+    void displayChanged()
+    {
+      if (_dirty.empty()) return;
+      for (uint8_t i = 0; i < _dirty.count(); i++)
+      {
+        GxEPD2_DirtyRegion::Box b = _dirty.box(i);
+        epd2.writeNativePart(_pixel_buffer, 0, b.x, b.y, WIDTH, _page_height, b.x, b.y, b.w, b.h);
+      }
+      GxEPD2_DirtyRegion::Box b = _dirty.bounds();
+      epd2.refresh(b.x, b.y, b.w, b.h);
+      _dirty.clear();
+    }
+
+    // number of changed parts displayChanged() would write, 0 if nothing changed
+    uint8_t changedParts()
+    {
+      return _dirty.count();
+    }
+
+#ifdef RPI
+    // as display(), but returns once the buffer is written to the controller, the buffer can be drawn to at once;
+    // refresh and power off continue in the background, see GxEPD2_EPD::refreshAsync()
+    std::shared_future<void> displayAsync(bool partial_update_mode = false, std::function<void()> done = nullptr)
+    {
+      epd2.writeNative(_pixel_buffer, 0, 0, 0, WIDTH, _page_height);
+      _dirty.clear();
+      return refreshAsync(partial_update_mode, done);
+    }
+#endif
+
     // display part of buffer content to screen, useful for full screen buffer
     // displayWindow, use parameters according to actual rotation.
     // x and w should be multiple of 8, for rotation 0 or 2,
@@ -168,6 +241,7 @@ class GxEPD2_7C : public GxEPD2_GFX_BASE_CLASS
       _pw_y = 0;
       _pw_w = WIDTH;
       _pw_h = HEIGHT;
+      _transform.invalidate();
     }
 
     // setPartialWindow, use parameters according to actual rotation.
@@ -188,6 +262,7 @@ class GxEPD2_7C : public GxEPD2_GFX_BASE_CLASS
       _pw_w += _pw_x % 2;
       if (_pw_w % 2 > 0) _pw_w += 2 - _pw_w % 2;
       _pw_x -= _pw_x % 2;
+      _transform.invalidate();
     }
 
     void firstPage()
@@ -363,6 +438,37 @@ class GxEPD2_7C : public GxEPD2_GFX_BASE_CLASS
     {
       epd2.writeImagePart(black, color, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h, false, false, false);
     }
+#ifdef RPI
+    // BMP file of any bit count to the buffer, dithered to the seven colors
+    bool writeBmpFile(const char *path, int16_t x, int16_t y, bool invert = false, bool mirror_y = false,
+                      GxEPD2_Dither::Method dither = GxEPD2_Dither::FLOYD_STEINBERG)
+    {
+      BMPfile::Image image;
+      if (!image.open(path)) return false;
+      int32_t w = image.width(), h = image.height();
+      image.close();
+      // the image rectangle, clipped to the buffer
+      int32_t x0 = x > 0 ? x : 0, y0 = y > 0 ? y : 0;
+      int32_t x1 = x + w < WIDTH ? x + w : WIDTH, y1 = y + h < _page_height ? y + h : _page_height;
+      if ((x0 >= x1) || (y0 >= y1)) return true;
+      // one color per pixel, packed by color7()
+      std::vector<uint16_t> pixels(uint32_t(w) * h);
+      if (!BMPfile::readBmpRgb7Color(path, pixels.data(), 0, 0, w, h, invert, mirror_y, dither)) return false;
+      for (int32_t row = y0; row < y1; row++)
+      {
+        const uint16_t* src = pixels.data() + (row - y) * w - x;
+        for (int32_t col = x0; col < x1; col++)
+        {
+          uint32_t p = uint32_t(row) * WIDTH + col;
+          uint8_t pv = color7(src[col]);
+          if (p & 1) _pixel_buffer[p / 2] = (_pixel_buffer[p / 2] & 0xF0) | pv;
+          else _pixel_buffer[p / 2] = (_pixel_buffer[p / 2] & 0x0F) | (pv << 4);
+        }
+      }
+      _dirty.add(x0, y0, x1 - x0, y1 - y0);
+      return true;
+    }
+#endif
     // write sprite of native data to controller memory, without screen refresh; x and w should be multiple of 8
     void writeNative(const uint8_t* data1, const uint8_t* data2, int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
     {
@@ -410,6 +516,22 @@ class GxEPD2_7C : public GxEPD2_GFX_BASE_CLASS
     {
       epd2.refresh(x, y, w, h);
     }
+#ifdef RPI
+    // as refresh(), but returns at once, see GxEPD2_EPD::refreshAsync()
+    std::shared_future<void> refreshAsync(bool partial_update_mode = false, std::function<void()> done = nullptr)
+    {
+      GxEPD2_Type* epd = &epd2;
+      return epd2.runAsync([epd, partial_update_mode]()
+      {
+        epd->refresh(partial_update_mode);
+        if (!partial_update_mode) epd->powerOff();
+      }, done);
+    }
+    std::shared_future<void> refreshAsync(int16_t x, int16_t y, int16_t w, int16_t h, std::function<void()> done = nullptr)
+    {
+      return epd2.refreshAsync(x, y, w, h, done);
+    }
+#endif
     // turns off generation of panel driving voltages, avoids screen fading over time
     void powerOff()
     {
@@ -456,6 +578,35 @@ class GxEPD2_7C : public GxEPD2_GFX_BASE_CLASS
           break;
       }
     }
+    // buffer rows first..last, of the current page and (partial) window, were changed
+    void _markDirtyRows(uint16_t first, uint16_t last)
+    {
+      uint16_t y0 = _pw_y + _current_page * _page_height + first;
+      uint16_t y1 = gx_uint16_min(_pw_y + _current_page * _page_height + last + 1, _pw_y + _pw_h);
+      if (y1 > y0) _dirty.add(_pw_x, y0, _pw_w, y1 - y0);
+    }
+    void _setPageHeight(uint16_t rows)
+    {
+      _page_height = rows;
+      _transform.invalidate();
+      _pages = (HEIGHT / _page_height) + ((HEIGHT % _page_height) > 0);
+      _current_page = 0;
+      _dirty.clear();
+    }
+    bool _setBuffer(uint8_t* buffer, uint32_t size, bool allocated)
+    {
+      if (size < uint32_t(WIDTH / 2))
+      {
+        if (allocated) free(buffer);
+        return false;
+      }
+      if (_buffer_allocated) free(_pixel_buffer);
+      _pixel_buffer = buffer;
+      _buffer_size = size;
+      _buffer_allocated = allocated;
+      _setPageHeight(gx_uint16_min(size / (WIDTH / 2), HEIGHT));
+      return true;
+    }
     uint8_t color7(uint16_t color)
     {
       static uint16_t _prev_color = GxEPD_BLACK;
@@ -495,7 +646,13 @@ class GxEPD2_7C : public GxEPD2_GFX_BASE_CLASS
       return cv7;
     }
   private:
-    uint8_t _pixel_buffer[(GxEPD2_Type::WIDTH / 2) * page_height];
+    // page_height 0: one row, the buffer is allocated at run time
+    uint8_t _page_buffer[(GxEPD2_Type::WIDTH / 2) * (page_height > 0 ? page_height : 1)];
+    uint8_t* _pixel_buffer; // _page_buffer, or allocated or given buffer of _buffer_size bytes
+    uint32_t _buffer_size;
+    bool _buffer_allocated;
+    GxEPD2_DirtyRegion _dirty;
+    GxEPD2_Transform _transform;
     bool _using_partial_mode, _second_phase, _mirror;
     uint16_t _width_bytes, _pixel_bytes;
     int16_t _current_page;
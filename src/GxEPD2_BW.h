@@ -31,6 +31,22 @@
 #endif
 
 #include "GxEPD2_EPD.h"
+#include "GxEPD2_DirtyRegion.h"
+#include "GxEPD2_Transform.h"
+#include "GxEPD2_Blit.h"
+#if defined(_GFX_H_)
+#include "GxEPD2_DisplayList.h"
+#endif
+
+#ifndef GxEPD2_BMP_BAND_ROWS
+// rows of a monochrome BMP file copied at a time by streamBmpFile(), when its rows can't be sent as they are in the file
+#define GxEPD2_BMP_BAND_ROWS 32
+#endif
+
+#ifndef GxEPD2_GLYPH_BYTES
+// largest unscaled glyph bitmap blitted by drawChar(), larger glyphs are drawn by pixels
+#define GxEPD2_GLYPH_BYTES 512
+#endif
 #include "epd/GxEPD2_102.h"
 #include "epd/GxEPD2_154.h"
 #include "epd/GxEPD2_154_D67.h"
@@ -45,6 +61,7 @@
 #include "epd/GxEPD2_213_M21.h"
 #ifdef RPI
 #include "BMPfile.h"
+#include "GxEPD2_ImageCache.h"
 #endif
 #include "epd/GxEPD2_213_T5D.h"
 #include "epd/GxEPD2_260.h"
@@ -80,15 +97,43 @@ class GxEPD2_BW : public GxEPD2_GFX_BASE_CLASS
     GxEPD2_BW(GxEPD2_Type epd2_instance) : GxEPD2_GFX_BASE_CLASS(GxEPD2_Type::WIDTH, GxEPD2_Type::HEIGHT), epd2(epd2_instance)
 #endif
     {
-      _page_height = page_height;
-      _pages = (HEIGHT / _page_height) + ((HEIGHT % _page_height) > 0);
       _reverse = (epd2_instance.panel == GxEPD2::GDE0213B1);
       _mirror = false;
       _using_partial_mode = false;
       _current_page = 0;
+      _shadow = 0;
+      _shadow_valid = false;
+      _buffer = _page_buffer;
+      _buffer_size = sizeof(_page_buffer);
+      _buffer_allocated = false;
+      _back_buffer = 0;
+      _back_allocated = false;
+#if defined(_GxEPD2_DisplayList_H_)
+      _list = 0;
+      _recording = false;
+#endif
+#ifdef RPI
+      _cache = 0;
+#endif
+      if (page_height > 0) _setPageHeight(page_height);
+      else if (!allocateBuffer()) _setPageHeight(1); // page_height 0: heap buffer, full frame if memory allows
       setFullWindow();
     }
 
+    ~GxEPD2_BW()
+    {
+#ifdef RPI
+      epd2.waitAsync(); // a refresh may still read a buffer
+#endif
+      free(_shadow);
+      if (_back_allocated) free(_back_buffer);
+      if (_buffer_allocated) free(_buffer);
+    }
+
+    // owns its buffers, not copyable
+    GxEPD2_BW(const GxEPD2_BW&) = delete;
+    GxEPD2_BW& operator=(const GxEPD2_BW&) = delete;
+
     uint16_t pages()
     {
       return _pages;
@@ -99,64 +144,155 @@ class GxEPD2_BW : public GxEPD2_GFX_BASE_CLASS
       return _page_height;
     }
 
+    // page height within the buffer size, e.g. HEIGHT for full frame or fewer rows for paged drawing; buffer content is lost
+    bool setPageHeight(uint16_t rows)
+    {
+      rows = gx_uint16_min(rows, HEIGHT);
+      if ((rows == 0) || (uint32_t(WIDTH / 8) * rows > _buffer_size)) return false;
+      _setPageHeight(rows);
+      return true;
+    }
+
+    // buffer from the heap instead of the buffer in the object, for a page height of rows;
+    // page height is halved until allocation succeeds; returns the page height, 0 if no buffer could be allocated
+    uint16_t allocateBuffer(uint16_t rows = GxEPD2_Type::HEIGHT)
+    {
+      for (uint16_t h = gx_uint16_min(rows, HEIGHT); h > 0; h /= 2)
+      {
+        uint8_t* buffer = (uint8_t*)malloc(uint32_t(WIDTH / 8) * h);
+        if (!buffer) continue;
+        _setBuffer(buffer, uint32_t(WIDTH / 8) * h, true);
+        return h;
+      }
+      return 0;
+    }
+
+    // buffer given by the caller, e.g. from a mmap'd region, used until changed; 0 selects the buffer in the object again.
+    // page height is as many rows as fit, at most HEIGHT; returns false if not a single row fits
+    bool setBuffer(uint8_t* buffer, uint32_t size)
+    {
+      if (!buffer) return _setBuffer(_page_buffer, sizeof(_page_buffer), false);
+      return _setBuffer(buffer, size, false);
+    }
+
+    uint32_t bufferSize()
+    {
+      return _buffer_size;
+    }
+
     bool mirror(bool m)
     {
       _swap_ (_mirror, m);
+      _transform.invalidate();
       return m;
     }
 
     void drawPixel(int16_t x, int16_t y, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE)
     {
-      if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
-      if (_mirror) x = width() - x - 1;
-      // check rotation, move pixel around if necessary
-      switch (getRotation())
+#if defined(_GxEPD2_DisplayList_H_)
+      if (_recording) return _list->drawPixel(x, y, color, mode);
+#endif
+      // mirror, rotation, window, page and _reverse are precomputed in _transform
+      _checkTransform();
+      if (!_transform.contains(x, y)) return;
+      uint32_t i = _transform.index(x, y);
+      if (_setPixel(_buffer + (i >> 3), 7 - (i & 7), color, mode)) _dirty.add(_transform.panelX(x, y), _transform.panelY(x, y));
+    }
+
+    // as drawPixel() for each pixel of the rectangle, but clipped and rotated once, and filled by whole bytes
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE)
+    {
+#if defined(_GxEPD2_DisplayList_H_)
+      if (_recording) return _list->fillRect(x, y, w, h, color, mode);
+#endif
+      int32_t x0, x1, y0, y1;
+      if (!_clipRect(x, y, w, h, x0, x1, y0, y1)) return;
+      int32_t page_ys = int32_t(_current_page) * _page_height;
+      uint16_t row_bytes = _pw_w / 8;
+      uint16_t b0 = x0 / 8, b1 = (x1 - 1) / 8;
+      uint8_t lmask = 0xFF >> (x0 & 7), rmask = 0xFF << (7 - ((x1 - 1) & 7));
+      if (b0 == b1) lmask &= rmask;
+      uint8_t c = color & 1;
+      bool changed = false;
+      for (int32_t y = y0; y < y1; y++)
       {
-        case 1:
-          _swap_(x, y);
-          x = WIDTH - x - 1;
-          break;
-        case 2:
-          x = WIDTH - x - 1;
-          y = HEIGHT - y - 1;
-          break;
-        case 3:
-          _swap_(x, y);
-          y = HEIGHT - y - 1;
-          break;
-      }
-      // transpose partial window to 0,0
-      x -= _pw_x;
-      y -= _pw_y;
-      // clip to (partial) window
-      if ((x < 0) || (x >= _pw_w) || (y < 0) || (y >= _pw_h)) return;
-      // adjust for current page
-      y -= _current_page * _page_height;
-      if (_reverse) y = _page_height - y - 1;
-      // check if in current page
-      if ((y < 0) || (y >= _page_height)) return;
-      uint8_t *bptr = _buffer + (y * (_pw_w >> 3)) + (x >> 3);
-      uint8_t bitNum = 7 - (x & 7);
-    uint8_t newColour, oldColour = 1 & (*bptr >> bitNum);
-      switch (mode) {
-      case GxEPD2_EPD::OVERWRITE: newColour = color; break;
-      case GxEPD2_EPD::INVERT: newColour = ~color; break;
-      case GxEPD2_EPD::XOR: newColour = oldColour ^ color; break;
-      case GxEPD2_EPD::INVERT_XOR: newColour = oldColour ^ ~color; break;
+        int32_t row = y - page_ys;
+        if (_reverse) row = _page_height - row - 1;
+        uint8_t* p = _buffer + row * row_bytes;
+        changed |= _fillSpan(p, b0, b1, lmask, rmask, c, mode);
       }
+      if (changed) _dirty.add(x0 + _pw_x, y0 + _pw_y, x1 - x0, y1 - y0);
+    }
 
-      newColour &= 1;
-      if (newColour != oldColour) {
-        *bptr = (*bptr & (0xFF ^ (1 << bitNum))) | (newColour << bitNum);
-       }
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE)
+    {
+      fillRect(x, y, w, 1, color, mode);
+    }
+
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE)
+    {
+      fillRect(x, y, 1, h, color, mode);
+    }
+
+#if defined(_GxEPD2_DisplayList_H_)
+    // GFX shapes, kept as such while recording to a display list, see setDisplayList()
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE)
+    {
+      if (_recording) _list->drawLine(x0, y0, x1, y1, color, mode);
+      else GxEPD2_GFX_BASE_CLASS::drawLine(x0, y0, x1, y1, color, mode);
+    }
+
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+    {
+      if (_recording) _list->drawRect(x, y, w, h, color);
+      else GxEPD2_GFX_BASE_CLASS::drawRect(x, y, w, h, color);
+    }
+
+    void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+    {
+      if (_recording) _list->drawCircle(x0, y0, r, color);
+      else GxEPD2_GFX_BASE_CLASS::drawCircle(x0, y0, r, color);
+    }
+
+    void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+    {
+      if (_recording) _list->fillCircle(x0, y0, r, color);
+      else GxEPD2_GFX_BASE_CLASS::fillCircle(x0, y0, r, color);
     }
 
+    void drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color)
+    {
+      if (_recording) _list->drawRoundRect(x, y, w, h, r, color);
+      else GxEPD2_GFX_BASE_CLASS::drawRoundRect(x, y, w, h, r, color);
+    }
+
+    void fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color)
+    {
+      if (_recording) _list->fillRoundRect(x, y, w, h, r, color);
+      else GxEPD2_GFX_BASE_CLASS::fillRoundRect(x, y, w, h, r, color);
+    }
+
+    void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
+    {
+      if (_recording) _list->drawTriangle(x0, y0, x1, y1, x2, y2, color);
+      else GxEPD2_GFX_BASE_CLASS::drawTriangle(x0, y0, x1, y1, x2, y2, color);
+    }
+
+    void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
+    {
+      if (_recording) _list->fillTriangle(x0, y0, x1, y1, x2, y2, color);
+      else GxEPD2_GFX_BASE_CLASS::fillTriangle(x0, y0, x1, y1, x2, y2, color);
+    }
+#endif
+
     bool init(uint32_t serial_diag_bitrate = 0) // = 0 : disabled
     {
       epd2.init(serial_diag_bitrate);
       _using_partial_mode = false;
       _current_page = 0;
       setFullWindow();
+      _dirty.clear();
+      _shadow_valid = false;
       return 1;
     }
 
@@ -172,20 +308,33 @@ class GxEPD2_BW : public GxEPD2_GFX_BASE_CLASS
       _using_partial_mode = false;
       _current_page = 0;
       setFullWindow();
+      _dirty.clear();
+      _shadow_valid = false;
     }
 
     void fillScreen(uint16_t color) // 0x0 black, >0x0 white, to buffer
     {
+#if defined(_GxEPD2_DisplayList_H_)
+      if (_recording) return _list->fillRect(0, 0, width(), height(), color);
+#endif
       uint8_t data = (color == GxEPD_BLACK) ? 0x00 : 0xFF;
-      for (uint16_t x = 0; x < sizeof(_buffer); x++)
-      {
-        _buffer[x] = data;
-      }
+      uint32_t first = 0, last = _pageBytes();
+      while ((first < last) && (_buffer[first] == data)) first++;
+      if (first == last) return; // unchanged
+      while (_buffer[last - 1] == data) last--;
+      memset(_buffer + first, data, last - first);
+      _markDirtyRows(first / (_pw_w / 8), (last - 1) / (_pw_w / 8));
     }
 
     // display buffer content to screen, useful for full screen buffer
+    // with setShadow(true), partial update writes only the rows changed since the last display
     void display(bool partial_update_mode = false)
     {
+      if (partial_update_mode && _shadowUsable())
+      {
+        _displayDiff();
+        return;
+      }
       if (partial_update_mode) epd2.writeImage(_buffer, 0, 0, WIDTH, _page_height);
       else epd2.writeImageForFullRefresh(_buffer, 0, 0, WIDTH, _page_height);
       epd2.refresh(partial_update_mode);
@@ -194,8 +343,112 @@ class GxEPD2_BW : public GxEPD2_GFX_BASE_CLASS
         epd2.writeImageAgain(_buffer, 0, 0, WIDTH, _page_height);
       }
       if (!partial_update_mode) epd2.powerOff();
+      _dirty.clear();
+      _updateShadow();
+    }
+
+    // display the parts of the buffer changed since the last display, with partial refresh; for full screen buffer.
+    // changed parts are tracked by drawPixel() and fillScreen(); all parts are written, then refreshed as one window
+    void displayChanged()
+    {
+      if (_shadowUsable())
+      {
+        _displayDiff();
+        return;
+      }
+      if (_dirty.empty()) return;
+      for (uint8_t i = 0; i < _dirty.count(); i++) _writeDirtyBox(_dirty.box(i), false);
+      GxEPD2_DirtyRegion::Box b = _dirty.bounds();
+      epd2.refresh(b.x, b.y, b.w, b.h);
+      if (epd2.hasFastPartialUpdate)
+      {
+        for (uint8_t i = 0; i < _dirty.count(); i++) _writeDirtyBox(_dirty.box(i), true);
+      }
+      _dirty.clear();
     }
 
+    // number of changed parts displayChanged() would write, 0 if nothing changed
+    uint8_t changedParts()
+    {
+      return _dirty.count();
+    }
+
+    // keep a copy of the frame last written to the controller, for full screen buffer;
+    // then display(true) and displayChanged() compare the buffer to it and write only the changed row spans,
+    // and skip the write to the controller's previous buffer if nothing changed. Costs a second buffer.
+    bool setShadow(bool enable)
+    {
+      if (!enable)
+      {
+        free(_shadow);
+        _shadow = 0;
+      }
+      else if (!_shadow) _shadow = (uint8_t*)malloc(_buffer_size);
+      _shadow_valid = false; // valid after the next full buffer display
+      return _shadow != 0;
+    }
+
+#ifdef RPI
+    // as display(), but returns once the buffer is written to the controller, the buffer can be drawn to at once;
+    // refresh and power off continue in the background, see GxEPD2_EPD::refreshAsync()
+    std::shared_future<void> displayAsync(bool partial_update_mode = false, std::function<void()> done = nullptr)
+    {
+      if (partial_update_mode) epd2.writeImage(_buffer, 0, 0, WIDTH, _page_height);
+      else epd2.writeImageForFullRefresh(_buffer, 0, 0, WIDTH, _page_height);
+      GxEPD2_Type* epd = &epd2;
+      // writeImageAgain follows the refresh, it needs a copy of the buffer
+      std::shared_ptr<std::vector<uint8_t>> again;
+      if (epd2.hasFastPartialUpdate) again = std::make_shared<std::vector<uint8_t>>(_buffer, _buffer + _pageBytes());
+      uint16_t h = _page_height;
+      _dirty.clear();
+      _updateShadow();
+      return epd2.runAsync([epd, partial_update_mode, again, h]()
+      {
+        epd->refresh(partial_update_mode);
+        if (again) epd->writeImageAgain(again->data(), 0, 0, GxEPD2_Type::WIDTH, h);
+        if (!partial_update_mode) epd->powerOff();
+      }, done);
+    }
+
+    // a second buffer for displaySwap(), for full screen buffer; false if none could be allocated
+    bool setDoubleBuffer(bool enable)
+    {
+      if (!enable) _freeBackBuffer();
+      else if (!_back_buffer && (_pages == 1))
+      {
+        _back_buffer = (uint8_t*)malloc(_buffer_size);
+        _back_allocated = (_back_buffer != 0);
+        if (_back_buffer) memcpy(_back_buffer, _buffer, _pageBytes());
+      }
+      return !enable || _back_buffer;
+    }
+
+    // as displayAsync(), but drawing continues in the second buffer while the refresh uses this one for writeImageAgain(),
+    // no copy is made. The second buffer holds an older frame: redraw it, the whole frame counts as changed for displayChanged().
+    // without setDoubleBuffer(true) this is displayAsync()
+    std::shared_future<void> displaySwap(bool partial_update_mode = false, std::function<void()> done = nullptr)
+    {
+      if (!_back_buffer || (_pages != 1)) return displayAsync(partial_update_mode, done);
+      if (partial_update_mode) epd2.writeImage(_buffer, 0, 0, WIDTH, _page_height);
+      else epd2.writeImageForFullRefresh(_buffer, 0, 0, WIDTH, _page_height);
+      GxEPD2_Type* epd = &epd2;
+      const uint8_t* again = epd2.hasFastPartialUpdate ? _buffer : 0;
+      uint16_t h = _page_height;
+      _updateShadow();
+      // the next controller write waits for this refresh, the buffer is free again then
+      _swap_(_buffer, _back_buffer);
+      _swap_(_buffer_allocated, _back_allocated);
+      _dirty.clear();
+      _dirty.add(0, 0, WIDTH, HEIGHT);
+      return epd2.runAsync([epd, partial_update_mode, again, h]()
+      {
+        epd->refresh(partial_update_mode);
+        if (again) epd->writeImageAgain(again, 0, 0, GxEPD2_Type::WIDTH, h);
+        if (!partial_update_mode) epd->powerOff();
+      }, done);
+    }
+#endif
+
     // display part of buffer content to screen, useful for full screen buffer
     // displayWindow, use parameters according to actual rotation.
     // x and w should be multiple of 8, for rotation 0 or 2,
@@ -210,6 +463,7 @@ class GxEPD2_BW : public GxEPD2_GFX_BASE_CLASS
       h = gx_uint16_min(h, height() - y);
       _rotate(x, y, w, h);
       uint16_t y_part = _reverse ? HEIGHT - h - y : y;
+      _shadow_valid = false;
       epd2.writeImagePart(_buffer, x, y_part, WIDTH, _page_height, x, y, w, h);
       epd2.refresh(x, y, w, h);
       if (epd2.hasFastPartialUpdate)
@@ -225,6 +479,7 @@ class GxEPD2_BW : public GxEPD2_GFX_BASE_CLASS
       _pw_y = 0;
       _pw_w = WIDTH;
       _pw_h = HEIGHT;
+      _transform.invalidate();
     }
 
     // setPartialWindow, use parameters according to actual rotation.
@@ -244,114 +499,47 @@ class GxEPD2_BW : public GxEPD2_GFX_BASE_CLASS
       _pw_w += _pw_x % 8;
       if (_pw_w % 8 > 0) _pw_w += 8 - _pw_w % 8;
       _pw_x -= _pw_x % 8;
+      _transform.invalidate();
     }
 
     void firstPage()
     {
+      _shadow_valid = false;
       fillScreen(GxEPD_WHITE);
       _current_page = 0;
       _second_phase = false;
+#if defined(_GxEPD2_DisplayList_H_)
+      _recording = _list && (_pages > 1);
+      if (_recording)
+      {
+        _list->clear();
+        _list->setRotation(getRotation());
+      }
+#endif
     }
 
     bool nextPage()
     {
-      if (1 == _pages)
+#if defined(_GxEPD2_DisplayList_H_)
+      if (_recording)
       {
-        if (_using_partial_mode)
+        // the drawing code ran once, into the list; each page of the usual sequence draws it instead
+        _recording = false;
+        do
         {
-          uint32_t offset = _reverse ? (HEIGHT - _pw_h) * _pw_w / 8 : 0;
-          epd2.writeImage(_buffer + offset, _pw_x, _pw_y, _pw_w, _pw_h);
-          epd2.refresh(_pw_x, _pw_y, _pw_w, _pw_h);
-          if (epd2.hasFastPartialUpdate)
-          {
-            epd2.writeImageAgain(_buffer + offset, _pw_x, _pw_y, _pw_w, _pw_h);
-            //epd2.refresh(_pw_x, _pw_y, _pw_w, _pw_h); // not needed
-          }
-        }
-        else // full update
-        {
-          epd2.writeImageForFullRefresh(_buffer, 0, 0, WIDTH, HEIGHT);
-          epd2.refresh(false);
-          if (epd2.hasFastPartialUpdate)
-          {
-            epd2.writeImageAgain(_buffer, 0, 0, WIDTH, HEIGHT);
-            //epd2.refresh(true); // not needed
-          }
-          epd2.powerOff();
+          _playPage(*_list);
         }
+        while (_nextPage());
         return false;
       }
-      uint16_t page_ys = _current_page * _page_height;
-      if (_using_partial_mode)
-      {
-        //Debug("  nextPage("); Debug(_pw_x); Debug(", "); Debug(_pw_y); Debug(", ");
-        //Debug(_pw_w); Debug(", "); Debug(_pw_h); Debug(") P"); Debugln(_current_page);
-        uint16_t page_ye = _current_page < (_pages - 1) ? page_ys + _page_height : HEIGHT;
-        uint16_t dest_ys = _pw_y + page_ys; // transposed
-        uint16_t dest_ye = gx_uint16_min(_pw_y + _pw_h, _pw_y + page_ye);
-        if (dest_ye > dest_ys)
-        {
-          //Debug("writeImage("); Debug(_pw_x); Debug(", "); Debug(dest_ys); Debug(", ");
-          //Debug(_pw_w); Debug(", "); Debug(dest_ye - dest_ys); Debugln(")");
-          uint32_t offset = _reverse ? (_page_height - (dest_ye - dest_ys)) * _pw_w / 8 : 0;
-          if (!_second_phase) epd2.writeImage(_buffer + offset, _pw_x, dest_ys, _pw_w, dest_ye - dest_ys);
-          else epd2.writeImageAgain(_buffer + offset, _pw_x, dest_ys, _pw_w, dest_ye - dest_ys);
-        }
-        else
-        {
-          //Debug("writeImage("); Debug(_pw_x); Debug(", "); Debug(dest_ys); Debug(", ");
-          //Debug(_pw_w); Debug(", "); Debug(dest_ye - dest_ys); Debug(") skipped ");
-          //Debug(dest_ys); Debug(".."); Debugln(dest_ye);
-        }
-        _current_page++;
-        if (_current_page == _pages)
-        {
-          _current_page = 0;
-          if (!_second_phase)
-          {
-            epd2.refresh(_pw_x, _pw_y, _pw_w, _pw_h);
-            if (epd2.hasFastPartialUpdate)
-            {
-              _second_phase = true;
-              fillScreen(GxEPD_WHITE);
-              return true;
-            }
-          }
-          return false;
-        }
-        fillScreen(GxEPD_WHITE);
-        return true;
-      }
-      else // full update
-      {
-        if (!_second_phase) epd2.writeImageForFullRefresh(_buffer, 0, page_ys, WIDTH, gx_uint16_min(_page_height, HEIGHT - page_ys));
-        else epd2.writeImageAgain(_buffer, 0, page_ys, WIDTH, gx_uint16_min(_page_height, HEIGHT - page_ys));
-        _current_page++;
-        if (_current_page == _pages)
-        {
-          _current_page = 0;
-          if (epd2.hasFastPartialUpdate)
-          {
-            if (!_second_phase)
-            {
-              epd2.refresh(false); // full update after first phase
-              _second_phase = true;
-              fillScreen(GxEPD_WHITE);
-              return true;
-            }
-            //else epd2.refresh(true); // partial update after second phase
-          } else epd2.refresh(false); // full update after only phase
-          epd2.powerOff();
-          return false;
-        }
-        fillScreen(GxEPD_WHITE);
-        return true;
-      }
+#endif
+      return _nextPage();
     }
 
     // GxEPD style paged drawing; drawCallback() is called as many times as needed
     void drawPaged(void (*drawCallback)(const void*), const void* pv)
     {
+      _shadow_valid = false;
       if (1 == _pages)
       {
         fillScreen(GxEPD_WHITE);
@@ -431,111 +619,255 @@ class GxEPD2_BW : public GxEPD2_GFX_BASE_CLASS
       _current_page = 0;
     }
 
+#if defined(_GxEPD2_DisplayList_H_)
+    // drawPaged() of a display list, each page draws only the commands that touch it.
+    // on RPI pages are rendered concurrently by up to threads threads, each into its own page buffer,
+    // and written to the controller in page order as they become ready; threads 0: one thread per processor core
+    void drawPaged(const GxEPD2_DisplayList& list, uint8_t threads = 0)
+    {
+#ifdef RPI
+      if (threads == 0) threads = gx_uint16_min(std::thread::hardware_concurrency(), 255);
+      threads = gx_uint16_min(threads, _pages);
+      if (threads > 1)
+      {
+        _drawPagedConcurrently(list, threads);
+        return;
+      }
+#endif
+      _PlayContext context = {this, &list};
+      drawPaged(_playList, &context);
+    }
+
+    // paged drawing with firstPage()/nextPage() runs the drawing code once: the first pass is recorded into list,
+    // then nextPage() draws all pages from it, with the same controller writes and refreshes, and returns false.
+    // 0 for the usual pass per page
+    void setDisplayList(GxEPD2_DisplayList* list)
+    {
+      _list = list;
+      _recording = false;
+    }
+#endif
+
+    // drawBitmap() of GFX, but blitted by whole bytes; set bits are drawn in color
+    void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE)
+    {
+#if defined(_GxEPD2_DisplayList_H_)
+      if (_recording && (mode == GxEPD2_EPD::OVERWRITE)) return _list->drawBitmap(x, y, bitmap, w, h, color);
+      if (_recording) return _recordBitmap(x, y, bitmap, w, h, color, true, mode);
+#endif
+      _drawBitmap(x, y, bitmap, w, h, GxEPD2_Blit::foreground(color & 1), mode);
+    }
+
+    // set bits are drawn in color, unset bits in bg
+    void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, uint16_t bg)
+    {
+#if defined(_GxEPD2_DisplayList_H_)
+      if (_recording) return _list->drawBitmap(x, y, bitmap, w, h, color, bg);
+#endif
+      _drawBitmap(x, y, bitmap, w, h, GxEPD2_Blit::opaque(color & 1, bg & 1), GxEPD2_EPD::OVERWRITE);
+    }
+
+    // unset bits are drawn in color
     void drawInvertedBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color)
     {
-      // taken from Adafruit_GFX.cpp, modified
-      int16_t byteWidth = (w + 7) / 8; // Bitmap scanline pad = whole byte
-      uint8_t byte = 0;
-      for (int16_t j = 0; j < h; j++)
+#if defined(_GxEPD2_DisplayList_H_)
+      if (_recording) return _recordBitmap(x, y, bitmap, w, h, color, false, GxEPD2_EPD::OVERWRITE);
+#endif
+      _drawBitmap(x, y, bitmap, w, h, GxEPD2_Blit::background(color & 1), GxEPD2_EPD::OVERWRITE);
+    }
+
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size)
+    {
+      drawChar(x, y, c, color, bg, size, size);
+    }
+
+    // as GFX::drawChar(), but glyphs outside the current page and (partial) window are skipped at once,
+    // and unscaled custom font glyphs are blitted by rows
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y)
+    {
+#if defined(_GxEPD2_DisplayList_H_)
+      if (_recording)
       {
-        for (int16_t i = 0; i < w; i++ )
-        {
-          if (i & 7) byte <<= 1;
-          else
-          {
-#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
-            byte = pgm_read_byte(&bitmap[j * byteWidth + i / 8]);
-#else
-            byte = bitmap[j * byteWidth + i / 8];
+        if (_list->getFont() != gfxFont) _list->setFont(gfxFont);
+        return _list->drawChar(x, y, c, color, bg, size_x, size_y);
+      }
 #endif
-          }
-          if (!(byte & 0x80))
-          {
-            drawPixel(x + i, y + j, color);
-          }
+      int32_t x0, x1, y0, y1;
+      if (!gfxFont)
+      {
+        if (!_clipRect(x, y, 6 * size_x, 8 * size_y, x0, x1, y0, y1)) return;
+        GxEPD2_GFX_BASE_CLASS::drawChar(x, y, c, color, bg, size_x, size_y);
+        return;
+      }
+      GFXglyph* glyph = gfxFont->glyph + (uint8_t)(c - gfxFont->first);
+      uint8_t w = glyph->width, h = glyph->height;
+      if (!_clipRect(x + glyph->xOffset * size_x, y + glyph->yOffset * size_y, w * size_x, h * size_y, x0, x1, y0, y1)) return;
+      uint8_t rows[GxEPD2_GLYPH_BYTES];
+      uint16_t row_bytes = (w + 7) / 8;
+      if ((size_x != 1) || (size_y != 1) || (row_bytes * h > int(sizeof(rows))))
+      {
+        GxEPD2_GFX_BASE_CLASS::drawChar(x, y, c, color, bg, size_x, size_y);
+        return;
+      }
+      // glyph bits run on from row to row, unpack them to rows of whole bytes
+      const uint8_t* bitmap = gfxFont->bitmap + glyph->bitmapOffset;
+      uint16_t bitmap_bytes = (w * h + 7) / 8;
+      for (uint8_t yy = 0; yy < h; yy++)
+      {
+        for (uint16_t b = 0; b < row_bytes; b++)
+        {
+          rows[yy * row_bytes + b] = GxEPD2_Blit::fetch8(bitmap, int32_t(yy) * w + b * 8, bitmap_bytes);
         }
       }
+      _drawBitmap(x + glyph->xOffset, y + glyph->yOffset, rows, w, h, GxEPD2_Blit::foreground(color & 1), GxEPD2_EPD::OVERWRITE);
     }
 
     //  Support for Bitmaps (Sprites) to Controller Buffer and to Screen
     void clearScreen(uint8_t value = 0xFF) // init controller memory and screen (default white)
     {
+      _shadow_valid = false;
       epd2.clearScreen(value);
     }
     void writeScreenBuffer(uint8_t value = 0xFF) // init controller memory (default white)
     {
+      _shadow_valid = false;
       epd2.writeScreenBuffer(value);
     }
     // write to controller memory, without screen refresh; x and w should be multiple of 8
     void writeImage(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false)
     {
+      _shadow_valid = false;
       epd2.writeImage(bitmap, x, y, w, h, invert, mirror_y, pgm);
     }
     void writeImagePart(const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
                         int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false)
     {
+      _shadow_valid = false;
       epd2.writeImagePart(bitmap, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h, invert, mirror_y, pgm);
     }
     void writeImage(const uint8_t* black, const uint8_t* color, int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
     {
+      _shadow_valid = false;
       epd2.writeImage(black, color, x, y, w, h, invert, mirror_y, pgm);
     }
     void writeImage(const uint8_t* black, const uint8_t* color, int16_t x, int16_t y, int16_t w, int16_t h)
     {
+      _shadow_valid = false;
       epd2.writeImage(black, color, x, y, w, h, false, false, false);
     }
     void writeImagePart(const uint8_t* black, const uint8_t* color, int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
                         int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
     {
+      _shadow_valid = false;
       epd2.writeImagePart(black, color, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h, invert, mirror_y, pgm);
     }
     void writeImagePart(const uint8_t* black, const uint8_t* color, int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
                         int16_t x, int16_t y, int16_t w, int16_t h)
     {
+      _shadow_valid = false;
       epd2.writeImagePart(black, color, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h, false, false, false);
     }
     // write sprite of native data to controller memory, without screen refresh; x and w should be multiple of 8
     void writeNative(const uint8_t* data1, const uint8_t* data2, int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
     {
+      _shadow_valid = false;
       epd2.writeNative(data1, data2, x, y, w, h, invert, mirror_y, pgm);
     }
     // write to controller memory, with screen refresh; x and w should be multiple of 8
     void drawImage(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false)
     {
+      _shadow_valid = false;
       epd2.drawImage(bitmap, x, y, w, h, invert, mirror_y, pgm);
     }
     void drawImagePart(const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
                        int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false)
     {
+      _shadow_valid = false;
       epd2.drawImagePart(bitmap, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h, invert, mirror_y, pgm);
     }
     void drawImage(const uint8_t* black, const uint8_t* color, int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
     {
+      _shadow_valid = false;
       epd2.drawImage(black, color, x, y, w, h, invert, mirror_y, pgm);
     }
     void drawImage(const uint8_t* black, const uint8_t* color, int16_t x, int16_t y, int16_t w, int16_t h)
     {
+      _shadow_valid = false;
       epd2.drawImage(black, color, x, y, w, h, false, false, false);
     }
     void drawImagePart(const uint8_t* black, const uint8_t* color, int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
                        int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
     {
+      _shadow_valid = false;
       epd2.drawImagePart(black, color, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h, invert, mirror_y, pgm);
     }
     void drawImagePart(const uint8_t* black, const uint8_t* color, int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
                        int16_t x, int16_t y, int16_t w, int16_t h)
     {
+      _shadow_valid = false;
       epd2.drawImagePart(black, color, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h, false, false, false);
     }
 #ifdef RPI
-    bool drawBmpFile(const char *path, uint16_t dispX, int16_t dispY, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE, bool mirror_y = false) {
+    // gray and color bitmaps are dithered to black and white
+    bool drawBmpFile(const char *path, int16_t dispX, int16_t dispY, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE, bool mirror_y = false,
+                     GxEPD2_Dither::Method dither = GxEPD2_Dither::FLOYD_STEINBERG) {
       if (dispX & 7) {
         Debug("Warning: x should be a multiple of 8");
       }
-//      hexDump(dispX, dispY, 100, 100);
-      if (!BMPfile::readBmpMono(path, _buffer, dispX / 8, dispY, epd2.WIDTH, epd2.HEIGHT, mode, mirror_y))
+      BMPfile::Image image;
+      if (!image.open(path)) return false;
+      int32_t w = (image.width() + 7) & ~7, h = image.height(); // rows are copied by whole bytes
+      image.close();
+      if (!BMPfile::readBmpMono(path, _buffer, dispX / 8, dispY, epd2.WIDTH, _page_height, mode, mirror_y, dither))
         return false;
-//      hexDump(0, 0, WIDTH, HEIGHT);
+      // the image rectangle, clipped to the buffer
+      int32_t x0 = (dispX / 8) * 8, y0 = dispY;
+      int32_t x1 = x0 + w < WIDTH ? x0 + w : WIDTH, y1 = y0 + h < _page_height ? y0 + h : _page_height;
+      if (x0 < 0) x0 = 0;
+      if (y0 < 0) y0 = 0;
+      if ((x1 > x0) && (y1 > y0)) _dirty.add(x0, y0, x1 - x0, y1 - y0);
+      return true;
+    }
+    // images for streamBmpFile() are converted once and kept in cache, 0 for none
+    void setImageCache(GxEPD2_ImageCache* cache)
+    {
+      _cache = cache;
+    }
+    // write a monochrome BMP file to controller memory, without screen refresh, placed as drawBmpFile() places it in the buffer;
+    // the buffer is not used, so images of any size show in paged mode too. x should be a multiple of 8
+    // with an image cache, gray and color BMP files are dithered too, and kept converted
+    bool streamBmpFile(const char *path, int16_t x, int16_t y, bool invert = false, bool mirror_y = false,
+                       GxEPD2_Dither::Method dither = GxEPD2_Dither::FLOYD_STEINBERG)
+    {
+      if (_cache) return _streamCached(path, x, y, invert, mirror_y, dither);
+      BMPfile::Image image;
+      if (!image.open(path) || (image.bitCount() != 1)) return false;
+      _shadow_valid = false;
+      int32_t h = image.height(), wb = (image.width() + 7) / 8;
+      // display row y + r shows file row r, or h - 1 - r if mirror_y
+      int32_t r0 = y < 0 ? -y : 0, r1 = int32_t(HEIGHT) - y < h ? int32_t(HEIGHT) - y : h;
+      if (r0 >= r1) return true;
+      if (!image.compressed() && (image.stride() == uint32_t(wb))) // wb >= 0
+      {
+        // the rows in the file are bitmap rows, bottom-up or top-down; the driver clips the columns
+        const uint8_t* first = image.row(mirror_y ? h - 1 - r0 : r0);
+        const uint8_t* last = image.row(mirror_y ? h - r1 : r1 - 1);
+        epd2.writeImage(first < last ? first : last, x, y + r0, wb * 8, r1 - r0, invert, last < first, false);
+        return true;
+      }
+      // copy the visible columns of a band of rows without the file's row padding
+      int32_t xb = x >> 3;
+      int32_t c0 = xb < 0 ? -xb : 0, c1 = int32_t(WIDTH / 8) - xb < wb ? int32_t(WIDTH / 8) - xb : wb;
+      if (c0 >= c1) return true;
+      uint8_t* band = (uint8_t*)malloc(uint32_t(c1 - c0) * GxEPD2_BMP_BAND_ROWS);
+      if (!band) return false;
+      for (int32_t r = r0; r < r1; r += GxEPD2_BMP_BAND_ROWS)
+      {
+        int32_t n = r1 - r < GxEPD2_BMP_BAND_ROWS ? r1 - r : GxEPD2_BMP_BAND_ROWS;
+        for (int32_t i = 0; i < n; i++) memcpy(band + i * (c1 - c0), image.row(mirror_y ? h - 1 - r - i : r + i) + c0, c1 - c0);
+        epd2.writeImage(band, (xb + c0) * 8, y + r, (c1 - c0) * 8, n, invert, false, false);
+      }
+      free(band);
       return true;
     }
 #endif
@@ -543,6 +875,7 @@ class GxEPD2_BW : public GxEPD2_GFX_BASE_CLASS
     // write sprite of native data to controller memory, with screen refresh; x and w should be multiple of 8
     void drawNative(const uint8_t* data1, const uint8_t* data2, int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
     {
+      _shadow_valid = false;
       epd2.drawNative(data1, data2, x, y, w, h, invert, mirror_y, pgm);
     }
     void refresh(bool partial_update_mode = false) // screen refresh from controller memory to full screen
@@ -554,6 +887,22 @@ class GxEPD2_BW : public GxEPD2_GFX_BASE_CLASS
     {
       epd2.refresh(x, y, w, h);
     }
+#ifdef RPI
+    // as refresh(), but returns at once, see GxEPD2_EPD::refreshAsync()
+    std::shared_future<void> refreshAsync(bool partial_update_mode = false, std::function<void()> done = nullptr)
+    {
+      GxEPD2_Type* epd = &epd2;
+      return epd2.runAsync([epd, partial_update_mode]()
+      {
+        epd->refresh(partial_update_mode);
+        if (!partial_update_mode) epd->powerOff();
+      }, done);
+    }
+    std::shared_future<void> refreshAsync(int16_t x, int16_t y, int16_t w, int16_t h, std::function<void()> done = nullptr)
+    {
+      return epd2.refreshAsync(x, y, w, h, done);
+    }
+#endif
     // turns off generation of panel driving voltages, avoids screen fading over time
     void powerOff()
     {
@@ -563,6 +912,7 @@ class GxEPD2_BW : public GxEPD2_GFX_BASE_CLASS
     void hibernate()
     {
       epd2.hibernate();
+      _shadow_valid = false; // controller RAM is lost, next update must rewrite both buffers
     }
 
     void hexDump(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
@@ -577,6 +927,102 @@ class GxEPD2_BW : public GxEPD2_GFX_BASE_CLASS
         Debug("\n\n");
     }
   private:
+    // nextPage() of the page buffer content
+    bool _nextPage()
+    {
+      if (1 == _pages)
+      {
+        if (_using_partial_mode)
+        {
+          uint32_t offset = _reverse ? (HEIGHT - _pw_h) * _pw_w / 8 : 0;
+          epd2.writeImage(_buffer + offset, _pw_x, _pw_y, _pw_w, _pw_h);
+          epd2.refresh(_pw_x, _pw_y, _pw_w, _pw_h);
+          if (epd2.hasFastPartialUpdate)
+          {
+            epd2.writeImageAgain(_buffer + offset, _pw_x, _pw_y, _pw_w, _pw_h);
+            //epd2.refresh(_pw_x, _pw_y, _pw_w, _pw_h); // not needed
+          }
+        }
+        else // full update
+        {
+          epd2.writeImageForFullRefresh(_buffer, 0, 0, WIDTH, HEIGHT);
+          epd2.refresh(false);
+          if (epd2.hasFastPartialUpdate)
+          {
+            epd2.writeImageAgain(_buffer, 0, 0, WIDTH, HEIGHT);
+            //epd2.refresh(true); // not needed
+          }
+          epd2.powerOff();
+        }
+        return false;
+      }
+      uint16_t page_ys = _current_page * _page_height;
+      if (_using_partial_mode)
+      {
+        //Debug("  nextPage("); Debug(_pw_x); Debug(", "); Debug(_pw_y); Debug(", ");
+        //Debug(_pw_w); Debug(", "); Debug(_pw_h); Debug(") P"); Debugln(_current_page);
+        uint16_t page_ye = _current_page < (_pages - 1) ? page_ys + _page_height : HEIGHT;
+        uint16_t dest_ys = _pw_y + page_ys; // transposed
+        uint16_t dest_ye = gx_uint16_min(_pw_y + _pw_h, _pw_y + page_ye);
+        if (dest_ye > dest_ys)
+        {
+          //Debug("writeImage("); Debug(_pw_x); Debug(", "); Debug(dest_ys); Debug(", ");
+          //Debug(_pw_w); Debug(", "); Debug(dest_ye - dest_ys); Debugln(")");
+          uint32_t offset = _reverse ? (_page_height - (dest_ye - dest_ys)) * _pw_w / 8 : 0;
+          if (!_second_phase) epd2.writeImage(_buffer + offset, _pw_x, dest_ys, _pw_w, dest_ye - dest_ys);
+          else epd2.writeImageAgain(_buffer + offset, _pw_x, dest_ys, _pw_w, dest_ye - dest_ys);
+        }
+        else
+        {
+          //Debug("writeImage("); Debug(_pw_x); Debug(", "); Debug(dest_ys); Debug(", ");
+          //Debug(_pw_w); Debug(", "); Debug(dest_ye - dest_ys); Debug(") skipped ");
+          //Debug(dest_ys); Debug(".."); Debugln(dest_ye);
+        }
+        _current_page++;
+        if (_current_page == _pages)
+        {
+          _current_page = 0;
+          if (!_second_phase)
+          {
+            epd2.refresh(_pw_x, _pw_y, _pw_w, _pw_h);
+            if (epd2.hasFastPartialUpdate)
+            {
+              _second_phase = true;
+              fillScreen(GxEPD_WHITE);
+              return true;
+            }
+          }
+          return false;
+        }
+        fillScreen(GxEPD_WHITE);
+        return true;
+      }
+      else // full update
+      {
+        if (!_second_phase) epd2.writeImageForFullRefresh(_buffer, 0, page_ys, WIDTH, gx_uint16_min(_page_height, HEIGHT - page_ys));
+        else epd2.writeImageAgain(_buffer, 0, page_ys, WIDTH, gx_uint16_min(_page_height, HEIGHT - page_ys));
+        _current_page++;
+        if (_current_page == _pages)
+        {
+          _current_page = 0;
+          if (epd2.hasFastPartialUpdate)
+          {
+            if (!_second_phase)
+            {
+              epd2.refresh(false); // full update after first phase
+              _second_phase = true;
+              fillScreen(GxEPD_WHITE);
+              return true;
+            }
+            //else epd2.refresh(true); // partial update after second phase
+          } else epd2.refresh(false); // full update after only phase
+          epd2.powerOff();
+          return false;
+        }
+        fillScreen(GxEPD_WHITE);
+        return true;
+      }
+    }
     template <typename T> static inline void
     _swap_(T & a, T & b)
     {
@@ -612,8 +1058,455 @@ class GxEPD2_BW : public GxEPD2_GFX_BASE_CLASS
           break;
       }
     }
+    // mirror and rotation are applied once per bitmap, rotation 1 and 3 blit the transposed bitmap
+    void _drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, const GxEPD2_Blit::Pen& pen, GxEPD2_EPD::writeMode mode)
+    {
+      if ((w <= 0) || (h <= 0)) return;
+      bool flip = _mirror;
+      if (_mirror) x = width() - x - w;
+      uint8_t rotation = getRotation();
+      if ((rotation == 0) || (rotation == 2))
+      {
+        if (rotation == 0) _blit(bitmap, (w + 7) / 8, w, h, x, y, flip, false, pen, mode);
+        else _blit(bitmap, (w + 7) / 8, w, h, int32_t(WIDTH) - x - w, int32_t(HEIGHT) - y - h, !flip, true, pen, mode);
+        return;
+      }
+      uint8_t* t = GxEPD2_Blit::transpose(bitmap, w, h);
+      if (!t) return;
+      if (rotation == 1) _blit(t, (h + 7) / 8, h, w, int32_t(WIDTH) - y - h, x, true, flip, pen, mode);
+      else _blit(t, (h + 7) / 8, h, w, y, int32_t(HEIGHT) - x - w, false, !flip, pen, mode);
+      free(t);
+    }
+    // bitmap rows to panel rows py.., or reversed; bits to panel x px.., or reversed; clipped to (partial) window and page
+    void _blit(const uint8_t* src, uint16_t row_bytes, uint16_t bits, uint16_t rows, int32_t px, int32_t py, bool reverse_bits, bool reverse_rows,
+               const GxEPD2_Blit::Pen& pen, GxEPD2_EPD::writeMode mode)
+    {
+      int32_t xa = px > _pw_x ? px : _pw_x;
+      int32_t xb = px + bits < _pw_x + _pw_w ? px + bits : _pw_x + _pw_w;
+      if (xa >= xb) return;
+      int32_t page_ys = int32_t(_current_page) * _page_height;
+      int32_t dirty_y0 = -1, dirty_y1 = -1;
+      for (uint16_t r = 0; r < rows; r++)
+      {
+        int32_t panel_y = py + (reverse_rows ? rows - 1 - r : r);
+        int32_t y = panel_y - _pw_y;
+        if ((y < 0) || (y >= _pw_h)) continue;
+        y -= page_ys;
+        if ((y < 0) || (y >= _page_height)) continue;
+        if (_reverse) y = _page_height - y - 1;
+        if (!GxEPD2_Blit::row(_buffer + y * (_pw_w / 8), _pw_x, src + uint32_t(r) * row_bytes, row_bytes, bits, px, reverse_bits, xa, xb, pen, mode)) continue;
+        if ((dirty_y0 < 0) || (panel_y < dirty_y0)) dirty_y0 = panel_y;
+        if (panel_y + 1 > dirty_y1) dirty_y1 = panel_y + 1;
+      }
+      if (dirty_y0 >= 0) _dirty.add(xa, dirty_y0, xb - xa, dirty_y1 - dirty_y0);
+    }
+    // rectangle in rotated coordinates to x0..x1 - 1, y0..y1 - 1 of the (partial) window, clipped to screen, window and current page;
+    // returns false if nothing is left
+    bool _clipRect(int16_t x, int16_t y, int16_t w, int16_t h, int32_t& x0, int32_t& x1, int32_t& y0, int32_t& y1)
+    {
+      // clip to the current page of the window, in rotated coordinates
+      _checkTransform();
+      int32_t xa = x > _transform.x0 ? x : _transform.x0, xb = int32_t(x) + w < _transform.x1 ? int32_t(x) + w : _transform.x1;
+      int32_t ya = y > _transform.y0 ? y : _transform.y0, yb = int32_t(y) + h < _transform.y1 ? int32_t(y) + h : _transform.y1;
+      if ((xa >= xb) || (ya >= yb)) return false;
+      if (_mirror)
+      {
+        int32_t t = xa;
+        xa = width() - xb;
+        xb = width() - t;
+      }
+      uint16_t rx = xa, ry = ya, rw = xb - xa, rh = yb - ya;
+      _rotate(rx, ry, rw, rh);
+      // transpose to (partial) window
+      x0 = int32_t(rx) - _pw_x;
+      x1 = x0 + rw;
+      y0 = int32_t(ry) - _pw_y;
+      y1 = y0 + rh;
+      return true;
+    }
+    void _checkTransform()
+    {
+      if (!_transform.valid(getRotation(), _current_page))
+        _transform.set(getRotation(), _mirror, width(), height(), WIDTH, HEIGHT, _pw_x, _pw_y, _pw_w, _pw_h, _current_page, _page_height, _reverse);
+    }
+    // applies color to bit bitNum of the buffer byte bptr; returns true if it changed
+    static bool _setPixel(uint8_t* bptr, uint8_t bitNum, uint16_t color, GxEPD2_EPD::writeMode mode)
+    {
+      uint8_t oldColour = 1 & (*bptr >> bitNum);
+      uint8_t newColour = color; // OVERWRITE
+      switch (mode)
+      {
+        case GxEPD2_EPD::OVERWRITE: break;
+        case GxEPD2_EPD::INVERT: newColour = ~color; break;
+        case GxEPD2_EPD::XOR: newColour = oldColour ^ color; break;
+        case GxEPD2_EPD::INVERT_XOR: newColour = oldColour ^ ~color; break;
+      }
+      newColour &= 1;
+      if (newColour == oldColour) return false;
+      *bptr = (*bptr & (0xFF ^ (1 << bitNum))) | (newColour << bitNum);
+      return true;
+    }
+    // applies color bit c to bytes b0..b1 of a buffer row, masked at the ends; returns true if a byte changed
+    static bool _fillSpan(uint8_t* p, uint16_t b0, uint16_t b1, uint8_t lmask, uint8_t rmask, uint8_t c, GxEPD2_EPD::writeMode mode)
+    {
+      if ((mode == GxEPD2_EPD::XOR) || (mode == GxEPD2_EPD::INVERT_XOR))
+      {
+        if ((mode == GxEPD2_EPD::XOR) != bool(c)) return false; // xor with 0
+        p[b0] ^= lmask;
+        if (b1 == b0) return true;
+        for (uint16_t b = b0 + 1; b < b1; b++) p[b] ^= 0xFF;
+        p[b1] ^= rmask;
+        return true;
+      }
+      if (mode == GxEPD2_EPD::INVERT) c = !c;
+      uint8_t v = c ? 0xFF : 0x00;
+      uint8_t old0 = p[b0], old1 = p[b1];
+      p[b0] = (p[b0] & ~lmask) | (v & lmask);
+      bool changed = p[b0] != old0;
+      if (b1 == b0) return changed;
+      p[b1] = (p[b1] & ~rmask) | (v & rmask);
+      changed |= p[b1] != old1;
+      for (uint16_t b = b0 + 1; (b < b1) && !changed; b++) changed = p[b] != v;
+      if (b1 > b0 + 1) memset(p + b0 + 1, v, b1 - b0 - 1);
+      return changed;
+    }
+    // buffer rows first..last, of the current page and (partial) window, were changed
+    void _markDirtyRows(uint16_t first, uint16_t last)
+    {
+      if (last >= _page_height) last = _page_height - 1;
+      if (first > last) return;
+      if (_reverse)
+      {
+        uint16_t t = _page_height - 1 - first;
+        first = _page_height - 1 - last;
+        last = t;
+      }
+      uint16_t y0 = _pw_y + _current_page * _page_height + first;
+      uint16_t y1 = gx_uint16_min(_pw_y + _current_page * _page_height + last + 1, _pw_y + _pw_h);
+      if (y1 > y0) _dirty.add(_pw_x, y0, _pw_w, y1 - y0);
+    }
+    void _writeDirtyBox(const GxEPD2_DirtyRegion::Box& b, bool again)
+    {
+      uint16_t y_part = _reverse ? HEIGHT - b.h - b.y : b.y;
+      if (again) epd2.writeImagePartAgain(_buffer, b.x, y_part, WIDTH, _page_height, b.x, b.y, b.w, b.h);
+      else epd2.writeImagePart(_buffer, b.x, y_part, WIDTH, _page_height, b.x, b.y, b.w, b.h);
+    }
+    bool _shadowUsable()
+    {
+      return _shadow_valid && (_pages == 1) && !_using_partial_mode;
+    }
+    void _updateShadow()
+    {
+      _shadow_valid = _shadow && (_pages == 1) && !_using_partial_mode;
+      if (_shadow_valid) memcpy(_shadow, _buffer, _pageBytes());
+    }
+    // true if the rows differ, in bytes first..last; memcmp() is vectorized by the C library
+    static bool _diffRow(const uint8_t* a, const uint8_t* b, uint16_t n, uint16_t& first, uint16_t& last)
+    {
+      if (memcmp(a, b, n) == 0) return false;
+      first = 0;
+      while (a[first] == b[first]) first++;
+      last = n - 1;
+      while (a[last] == b[last]) last--;
+      return true;
+    }
+    // writes each run of changed rows as one window, returns false if nothing changed; bounds grows to include the windows.
+    // a run continues over unchanged rows while they cost fewer bytes than setting up a new window
+    bool _writeDiff(bool again, GxEPD2_DirtyRegion::Box& bounds)
+    {
+      const uint16_t window_bytes = 16;
+      const uint16_t wb = WIDTH / 8;
+      bool any = false;
+      int32_t run_start = -1;
+      uint16_t run_end = 0, first = 0, last = 0, x0 = 0, x1 = 0;
+      for (uint16_t row = 0; row <= HEIGHT; row++)
+      {
+        if ((row < HEIGHT) && _diffRow(_buffer + uint32_t(row) * wb, _shadow + uint32_t(row) * wb, wb, first, last))
+        {
+          if (run_start < 0)
+          {
+            run_start = row;
+            x0 = first;
+            x1 = last;
+          }
+          x0 = gx_uint16_min(x0, first);
+          x1 = gx_uint16_max(x1, last);
+          run_end = row + 1;
+          continue;
+        }
+        if ((run_start < 0) || ((row < HEIGHT) && (row + 1 - run_end) * (x1 - x0 + 1) < window_bytes)) continue;
+        uint16_t h = run_end - run_start;
+        GxEPD2_DirtyRegion::Box b = {uint16_t(x0 * 8), uint16_t(_reverse ? HEIGHT - run_end : run_start), uint16_t((x1 - x0 + 1) * 8), h};
+        if (again) epd2.writeImagePartAgain(_buffer, b.x, run_start, WIDTH, _page_height, b.x, b.y, b.w, b.h);
+        else epd2.writeImagePart(_buffer, b.x, run_start, WIDTH, _page_height, b.x, b.y, b.w, b.h);
+        if (!any && (bounds.w == 0)) bounds = b;
+        uint16_t bx1 = gx_uint16_max(bounds.x + bounds.w, b.x + b.w), by1 = gx_uint16_max(bounds.y + bounds.h, b.y + b.h);
+        bounds.x = gx_uint16_min(bounds.x, b.x);
+        bounds.y = gx_uint16_min(bounds.y, b.y);
+        bounds.w = bx1 - bounds.x;
+        bounds.h = by1 - bounds.y;
+        any = true;
+        run_start = -1;
+      }
+      return any;
+    }
+    // partial update of the rows changed since the shadow was taken; no write and no refresh if none changed
+    void _displayDiff()
+    {
+      GxEPD2_DirtyRegion::Box b = {0, 0, 0, 0};
+      if (_writeDiff(false, b))
+      {
+        epd2.refresh(b.x, b.y, b.w, b.h);
+        if (epd2.hasFastPartialUpdate) _writeDiff(true, b);
+        memcpy(_shadow, _buffer, _pageBytes());
+      }
+      _dirty.clear();
+    }
+    uint32_t _pageBytes()
+    {
+      return uint32_t(WIDTH / 8) * _page_height;
+    }
+    void _setPageHeight(uint16_t rows)
+    {
+      _page_height = rows;
+      _pages = (HEIGHT / _page_height) + ((HEIGHT % _page_height) > 0);
+      _current_page = 0;
+      _transform.invalidate();
+      _shadow_valid = false;
+      _dirty.clear();
+    }
+    bool _setBuffer(uint8_t* buffer, uint32_t size, bool allocated)
+    {
+      if (size < uint32_t(WIDTH / 8))
+      {
+        if (allocated) free(buffer);
+        return false;
+      }
+      _freeBackBuffer();
+      if (_buffer_allocated) free(_buffer);
+      _buffer = buffer;
+      _buffer_size = size;
+      _buffer_allocated = allocated;
+      _setPageHeight(gx_uint16_min(size / (WIDTH / 8), HEIGHT));
+      if (_shadow)
+      {
+        free(_shadow);
+        _shadow = (uint8_t*)malloc(_buffer_size); // off if there is no memory for it
+      }
+      return true;
+    }
+#ifdef RPI
+    // streamBmpFile() from the image cache; on a miss the image is converted whole, stored, and written from memory
+    bool _streamCached(const char *path, int16_t x, int16_t y, bool invert, bool mirror_y, GxEPD2_Dither::Method dither)
+    {
+      GxEPD2_ImageCache::Key key = {path, uint16_t(epd2.panel), GxEPD2_ImageCache::MONO, uint8_t(mirror_y | (dither << 1))};
+      GxEPD2_ImageCache::Entry entry;
+      _shadow_valid = false;
+      if (!_cache->find(key, entry))
+      {
+        BMPfile::Image image;
+        if (!image.open(path)) return false;
+        uint16_t w = image.width(), h = image.height(), wb = (w + 7) / 8;
+        image.close();
+        uint8_t* rows = (uint8_t*)malloc(uint32_t(wb) * h);
+        if (!rows) return false;
+        bool ok = BMPfile::readBmpMono(path, rows, 0, 0, w, h, GxEPD2_EPD::OVERWRITE, mirror_y, dither);
+        if (ok)
+        {
+          _cache->store(key, w, h, wb, 1, rows);
+          epd2.writeImage(rows, x, y, wb * 8, h, invert, false, false);
+        }
+        free(rows);
+        return ok;
+      }
+      epd2.writeImage(entry.plane(0), x, y, entry.rowBytes() * 8, entry.height(), invert, false, false);
+      return true;
+    }
+#endif
+    // frees the second buffer; drawing continues in the buffer set by setBuffer() or allocateBuffer()
+    void _freeBackBuffer()
+    {
+      if (!_back_buffer) return;
+#ifdef RPI
+      epd2.waitAsync(); // a refresh may still read it
+#endif
+      if (!_back_allocated)
+      {
+        memcpy(_back_buffer, _buffer, _pageBytes());
+        _swap_(_buffer, _back_buffer);
+        _swap_(_buffer_allocated, _back_allocated);
+      }
+      if (_back_allocated) free(_back_buffer);
+      _back_buffer = 0;
+      _back_allocated = false;
+    }
+#if defined(_GxEPD2_DisplayList_H_)
+#ifdef RPI
+    // render target of _renderPages(): a page buffer and the transform of master for one page, no driver.
+    // bitmaps and glyphs are drawn by the GFX pixel loops, rectangles by whole bytes
+    class _PageRenderer : public GFX
+    {
+      public:
+        // rotation and text settings of master; mirror, window and page height are read from master for each page
+        _PageRenderer(const GxEPD2_BW& master, uint8_t* buffer) : GFX(master), _master(master), _buffer(buffer) {};
+        const uint8_t* buffer() const
+        {
+          return _buffer;
+        };
+        // clears the buffer to white and draws the commands of list that touch page
+        void render(const GxEPD2_DisplayList& list, uint16_t page)
+        {
+          const GxEPD2_BW& m = _master;
+          _transform.set(getRotation(), m._mirror, width(), height(), WIDTH, HEIGHT, m._pw_x, m._pw_y, m._pw_w, m._pw_h, page, m._page_height, m._reverse);
+          memset(_buffer, 0xFF, uint32_t(WIDTH / 8) * m._page_height);
+          list.play(*this, _transform.x0, _transform.y0, _transform.x1, _transform.y1);
+        };
+        void drawPixel(int16_t x, int16_t y, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE)
+        {
+          if (!_transform.contains(x, y)) return;
+          uint32_t i = _transform.index(x, y);
+          _setPixel(_buffer + (i >> 3), 7 - (i & 7), color, mode);
+        };
+        void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE)
+        {
+          int32_t xa = x > _transform.x0 ? x : _transform.x0, xb = int32_t(x) + w < _transform.x1 ? int32_t(x) + w : _transform.x1;
+          int32_t ya = y > _transform.y0 ? y : _transform.y0, yb = int32_t(y) + h < _transform.y1 ? int32_t(y) + h : _transform.y1;
+          if ((xa >= xb) || (ya >= yb)) return;
+          // opposite corners in the page buffer
+          uint16_t pw_w = _master._pw_w;
+          uint32_t i0 = _transform.index(xa, ya), i1 = _transform.index(xb - 1, yb - 1);
+          uint32_t c0 = i0 % pw_w, c1 = i1 % pw_w, r0 = i0 / pw_w, r1 = i1 / pw_w;
+          if (c0 > c1) _swap_(c0, c1);
+          if (r0 > r1) _swap_(r0, r1);
+          uint16_t b0 = c0 / 8, b1 = c1 / 8;
+          uint8_t lmask = 0xFF >> (c0 & 7), rmask = 0xFF << (7 - (c1 & 7));
+          if (b0 == b1) lmask &= rmask;
+          for (uint32_t r = r0; r <= r1; r++) _fillSpan(_buffer + r * (pw_w / 8), b0, b1, lmask, rmask, color & 1, mode);
+        };
+      private:
+        const GxEPD2_BW& _master;
+        uint8_t* _buffer;
+        GxEPD2_Transform _transform;
+    };
+#endif
+    struct _PlayContext
+    {
+      GxEPD2_BW* display;
+      const GxEPD2_DisplayList* list;
+    };
+    static void _playList(const void* pv)
+    {
+      const _PlayContext* context = (const _PlayContext*)pv;
+      context->display->_playPage(*context->list);
+    }
+    void _playPage(const GxEPD2_DisplayList& list)
+    {
+      _checkTransform();
+      list.play(*this, _transform.x0, _transform.y0, _transform.x1, _transform.y1);
+    }
+    // bitmaps the list can't keep as such, by pixels
+    void _recordBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, bool set_bits, GxEPD2_EPD::writeMode mode)
+    {
+      uint16_t row_bytes = (w + 7) / 8;
+      for (int16_t j = 0; j < h; j++)
+      {
+        for (int16_t i = 0; i < w; i++)
+        {
+          bool set = GxEPD2_BLIT_READ(bitmap + j * row_bytes + i / 8) & (0x80 >> (i & 7));
+          if (set == set_bits) _list->drawPixel(x + i, y + j, color, mode);
+        }
+      }
+    }
+#ifdef RPI
+    void _drawPagedConcurrently(const GxEPD2_DisplayList& list, uint8_t threads)
+    {
+      _shadow_valid = false;
+      if (_using_partial_mode)
+      {
+        for (uint16_t phase = 1; phase <= 2; phase++)
+        {
+          _renderPages(list, threads, [this, phase](const uint8_t* buffer, uint16_t page)
+          {
+            uint16_t page_ys = page * _page_height;
+            uint16_t page_ye = page < (_pages - 1) ? page_ys + _page_height : HEIGHT;
+            uint16_t dest_ys = _pw_y + page_ys; // transposed
+            uint16_t dest_ye = gx_uint16_min(_pw_y + _pw_h, _pw_y + page_ye);
+            if (dest_ye <= dest_ys) return;
+            uint32_t offset = _reverse ? (_page_height - (dest_ye - dest_ys)) * _pw_w / 8 : 0;
+            if (phase == 1) epd2.writeImage(buffer + offset, _pw_x, dest_ys, _pw_w, dest_ye - dest_ys);
+            else epd2.writeImageAgain(buffer + offset, _pw_x, dest_ys, _pw_w, dest_ye - dest_ys);
+          });
+          epd2.refresh(_pw_x, _pw_y, _pw_w, _pw_h);
+          if (!epd2.hasFastPartialUpdate) break;
+          // else make both controller buffers have equal content
+        }
+      }
+      else // full update
+      {
+        _renderPages(list, threads, [this](const uint8_t* buffer, uint16_t page)
+        {
+          uint16_t page_ys = page * _page_height;
+          epd2.writeImageForFullRefresh(buffer, 0, page_ys, WIDTH, gx_uint16_min(_page_height, HEIGHT - page_ys));
+        });
+        epd2.refresh(false); // full update after first phase
+        if (epd2.hasFastPartialUpdate)
+        {
+          // make both controller buffers have equal content
+          _renderPages(list, threads, [this](const uint8_t* buffer, uint16_t page)
+          {
+            uint16_t page_ys = page * _page_height;
+            epd2.writeImageAgain(buffer, 0, page_ys, WIDTH, gx_uint16_min(_page_height, HEIGHT - page_ys));
+          });
+        }
+        epd2.powerOff();
+      }
+    }
+    // renders all pages, threads at a time, and calls upload() with each page buffer in page order;
+    // a renderer starts on its next page once its page is uploaded
+    void _renderPages(const GxEPD2_DisplayList& list, uint8_t threads, std::function<void(const uint8_t*, uint16_t)> upload)
+    {
+      uint32_t bytes = _pageBytes();
+      std::vector<uint8_t> buffers(bytes * threads);
+      std::vector<std::unique_ptr<_PageRenderer>> renderers;
+      std::vector<std::future<void>> jobs(threads);
+      for (uint8_t t = 0; t < threads; t++) renderers.emplace_back(new _PageRenderer(*this, buffers.data() + t * bytes));
+      auto render = [&list](_PageRenderer* renderer, uint16_t page)
+      {
+        return std::async(std::launch::async, [&list, renderer, page]()
+        {
+          renderer->render(list, page);
+        });
+      };
+      for (uint8_t t = 0; t < threads; t++) jobs[t] = render(renderers[t].get(), t);
+      for (uint16_t page = 0; page < _pages; page++)
+      {
+        uint8_t t = page % threads;
+        jobs[t].get();
+        upload(renderers[t]->buffer(), page);
+        if (page + threads < _pages) jobs[t] = render(renderers[t].get(), page + threads);
+      }
+    }
+#endif
+#endif
   private:
-    uint8_t _buffer[(GxEPD2_Type::WIDTH / 8) * page_height];
+    // page_height 0: one row, the buffer is allocated at run time
+    uint8_t _page_buffer[(GxEPD2_Type::WIDTH / 8) * (page_height > 0 ? page_height : 1)];
+    uint8_t* _buffer; // _page_buffer, or allocated or given buffer of _buffer_size bytes
+    uint32_t _buffer_size;
+    bool _buffer_allocated;
+    uint8_t* _back_buffer; // second buffer for displaySwap(), or 0
+    bool _back_allocated;
+    GxEPD2_DirtyRegion _dirty;
+    GxEPD2_Transform _transform;
+#if defined(_GxEPD2_DisplayList_H_)
+    GxEPD2_DisplayList* _list; // for setDisplayList()
+    bool _recording; // first pass of firstPage()/nextPage() draws to _list
+#endif
+#ifdef RPI
+    GxEPD2_ImageCache* _cache; // for setImageCache()
+#endif
+    uint8_t* _shadow; // copy of the frame in controller memory, or 0
+    bool _shadow_valid;
     bool _using_partial_mode, _second_phase, _mirror, _reverse;
     uint16_t _width_bytes, _pixel_bytes;
     int16_t _current_page;
@@ -0,0 +1,150 @@
+// Byte-wise blitting of 1 bit per pixel bitmaps into the buffers of GxEPD2_BW and GxEPD2_3C.
+//
+// Bitmaps are in Adafruit_GFX drawBitmap() format: rows padded to whole bytes, msb is the leftmost pixel.
+// A Pen says what happens to the buffer bits under set and unset bitmap bits, a writeMode how they combine.
+// Rotation 1 and 3 blit the bitmap transposed, see transpose().
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#ifndef _GxEPD2_Blit_H_
+#define _GxEPD2_Blit_H_
+
+#include "GxEPD2_EPD.h"
+
+#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
+#define GxEPD2_BLIT_READ(p) pgm_read_byte(p)
+#else
+#define GxEPD2_BLIT_READ(p) (*(p))
+#endif
+
+class GxEPD2_Blit
+{
+  public:
+    struct Pen
+    {
+      uint8_t fg_mask, fg; // set bitmap bits: 0xFF to draw, and the value drawn (0x00 or 0xFF)
+      uint8_t bg_mask, bg; // unset bitmap bits
+    };
+    // set bits drawn in color bit c, unset bits transparent
+    static Pen foreground(uint8_t c)
+    {
+      Pen p = {0xFF, uint8_t(c ? 0xFF : 0x00), 0x00, 0x00};
+      return p;
+    };
+    // unset bits drawn in color bit c, set bits transparent
+    static Pen background(uint8_t c)
+    {
+      Pen p = {0x00, 0x00, 0xFF, uint8_t(c ? 0xFF : 0x00)};
+      return p;
+    };
+    static Pen opaque(uint8_t c, uint8_t bg)
+    {
+      Pen p = {0xFF, uint8_t(c ? 0xFF : 0x00), 0xFF, uint8_t(bg ? 0xFF : 0x00)};
+      return p;
+    };
+    static uint8_t reverse(uint8_t b)
+    {
+      b = (b >> 4) | (b << 4);
+      b = ((b & 0xCC) >> 2) | ((b & 0x33) << 2);
+      return ((b & 0xAA) >> 1) | ((b & 0x55) << 1);
+    };
+    // 8 bits of a bitmap row from bit k on, k may be negative or beyond the row; missing bits are 0
+    static uint8_t fetch8(const uint8_t* row, int32_t k, uint16_t row_bytes)
+    {
+      int32_t b = k >> 3;
+      uint8_t shift = k & 7;
+      uint8_t hi = (b >= 0) && (b < row_bytes) ? GxEPD2_BLIT_READ(row + b) : 0;
+      if (shift == 0) return hi;
+      uint8_t lo = (b + 1 >= 0) && (b + 1 < row_bytes) ? GxEPD2_BLIT_READ(row + b + 1) : 0;
+      return uint8_t(((uint16_t(hi) << 8) | lo) >> (8 - shift));
+    };
+    // transposes 8 rows of 8 pixels, in[i] is row i; out[i] becomes column i, msb from row 0
+    static void transpose8(const uint8_t in[8], uint8_t out[8])
+    {
+      uint64_t x = 0;
+      for (uint8_t i = 0; i < 8; i++) x = (x << 8) | in[i];
+      uint64_t t;
+      t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+      x = x ^ t ^ (t << 7);
+      t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+      x = x ^ t ^ (t << 14);
+      t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+      x = x ^ t ^ (t << 28);
+      for (int8_t i = 7; i >= 0; i--)
+      {
+        out[i] = x & 0xFF;
+        x >>= 8;
+      }
+    };
+    // bitmap of w x h pixels to h x w pixels, row i of the result is column i of the bitmap;
+    // returns a malloc()ed array of w rows of (h + 7) / 8 bytes, to be free()d, or 0
+    static uint8_t* transpose(const uint8_t* bitmap, int16_t w, int16_t h)
+    {
+      uint16_t src_bytes = (w + 7) / 8, dst_bytes = (h + 7) / 8;
+      uint8_t* t = (uint8_t*)malloc(uint32_t(w) * dst_bytes);
+      if (!t) return 0;
+      uint8_t in[8], out[8];
+      for (int16_t j = 0; j < h; j += 8)
+      {
+        for (uint16_t b = 0; b < src_bytes; b++)
+        {
+          for (uint8_t r = 0; r < 8; r++) in[r] = j + r < h ? GxEPD2_BLIT_READ(bitmap + uint32_t(j + r) * src_bytes + b) : 0;
+          transpose8(in, out);
+          for (uint8_t c = 0; c < 8 && b * 8 + c < w; c++) t[uint32_t(b * 8 + c) * dst_bytes + j / 8] = out[c];
+        }
+      }
+      return t;
+    };
+    // combines the bitmap bits s into buffer byte d, within edge mask; returns true if d changed
+    static bool apply(uint8_t& d, uint8_t s, uint8_t edge, const Pen& pen, GxEPD2_EPD::writeMode mode)
+    {
+      uint8_t m = ((s & pen.fg_mask) | (~s & pen.bg_mask)) & edge;
+      uint8_t v = (s & pen.fg) | (~s & pen.bg);
+      uint8_t old = d;
+      switch (mode)
+      {
+        case GxEPD2_EPD::OVERWRITE: d = (d & ~m) | (v & m); break;
+        case GxEPD2_EPD::INVERT: d = (d & ~m) | (~v & m); break;
+        case GxEPD2_EPD::XOR: d ^= v & m; break;
+        case GxEPD2_EPD::INVERT_XOR: d ^= ~v & m; break;
+      }
+      return d != old;
+    };
+    // blits bits of one bitmap row to a buffer row; bitmap bit k goes to x = x0 + k, or x = x0 + bits - 1 - k if reversed.
+    // only x in xa..xb - 1 is written, dst[0] holds x = dst_x..dst_x + 7 with dst_x a multiple of 8; returns true if changed
+    static bool row(uint8_t* dst, int32_t dst_x, const uint8_t* src, uint16_t row_bytes, uint16_t bits, int32_t x0, bool reversed,
+                    int32_t xa, int32_t xb, const Pen& pen, GxEPD2_EPD::writeMode mode)
+    {
+      bool changed = false;
+      int32_t b0 = (xa - dst_x) >> 3, b1 = (xb - 1 - dst_x) >> 3;
+      uint8_t lmask = 0xFF >> ((xa - dst_x) & 7), rmask = 0xFF << (7 - ((xb - 1 - dst_x) & 7));
+      // aligned plain copy, the usual case for icons drawn at x multiple of 8
+      if (!reversed && (((x0 - dst_x) & 7) == 0) && (mode == GxEPD2_EPD::OVERWRITE) && (pen.fg_mask & pen.bg_mask) && (pen.fg == 0xFF) && (pen.bg == 0x00) && (b1 > b0 + 1))
+      {
+        const uint8_t* s = src + (dst_x + (b0 + 1) * 8 - x0) / 8;
+        changed |= apply(dst[b0], fetch8(src, dst_x + b0 * 8 - x0, row_bytes), lmask, pen, mode);
+        for (int32_t b = b0 + 1; b < b1; b++, s++)
+        {
+          uint8_t v = GxEPD2_BLIT_READ(s);
+          changed |= dst[b] != v;
+          dst[b] = v;
+        }
+        changed |= apply(dst[b1], fetch8(src, dst_x + b1 * 8 - x0, row_bytes), rmask, pen, mode);
+        return changed;
+      }
+      for (int32_t b = b0; b <= b1; b++)
+      {
+        uint8_t edge = (b == b0 ? lmask : 0xFF) & (b == b1 ? rmask : 0xFF);
+        int32_t k = dst_x + b * 8 - x0; // bitmap bit at the msb of dst[b]
+        uint8_t s = reversed ? reverse(fetch8(src, bits - k - 8, row_bytes)) : fetch8(src, k, row_bytes);
+        changed |= apply(dst[b], s, edge, pen, mode);
+      }
+      return changed;
+    };
+};
+
+#endif
@@ -0,0 +1,155 @@
+// Bounding boxes of the pixels changed in a display buffer since it was last displayed.
+// Used by GxEPD2_BW, GxEPD2_3C and GxEPD2_7C for displayChanged().
+//
+// Boxes are in panel coordinates (rotation 0, full window), x is aligned to the controller's
+// addressing granularity. Up to MAX_BOXES boxes are kept, a box that would not fit is merged
+// with the box it grows least. Boxes less than ROW_GAP rows apart are merged, a window costs
+// about as many command bytes on the wire as a few short rows.
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#ifndef _GxEPD2_DirtyRegion_H_
+#define _GxEPD2_DirtyRegion_H_
+
+#include <stdint.h>
+
+#ifndef GxEPD2_DIRTY_BOXES
+#define GxEPD2_DIRTY_BOXES 4
+#endif
+
+class GxEPD2_DirtyRegion
+{
+  public:
+    static const uint8_t MAX_BOXES = GxEPD2_DIRTY_BOXES;
+    static const uint8_t ROW_GAP = 8;
+    struct Box
+    {
+      uint16_t x, y, w, h;
+    };
+    // align: x granularity in pixels, a power of 2
+    GxEPD2_DirtyRegion(uint8_t align = 8) : _align(align), _count(0), _last(0) {};
+    void clear()
+    {
+      _count = 0;
+      _last = 0;
+    };
+    bool empty() const
+    {
+      return _count == 0;
+    };
+    uint8_t count() const
+    {
+      return _count;
+    };
+    // i < count(), w and h of the box are > 0
+    Box box(uint8_t i) const
+    {
+      Box b = {_x0[i], _y0[i], uint16_t(_x1[i] - _x0[i]), uint16_t(_y1[i] - _y0[i])};
+      return b;
+    };
+    // bounding box of all boxes
+    Box bounds() const
+    {
+      Box b = {0, 0, 0, 0};
+      if (_count == 0) return b;
+      uint16_t x0 = _x0[0], y0 = _y0[0], x1 = _x1[0], y1 = _y1[0];
+      for (uint8_t i = 1; i < _count; i++)
+      {
+        if (_x0[i] < x0) x0 = _x0[i];
+        if (_y0[i] < y0) y0 = _y0[i];
+        if (_x1[i] > x1) x1 = _x1[i];
+        if (_y1[i] > y1) y1 = _y1[i];
+      }
+      b.x = x0;
+      b.y = y0;
+      b.w = x1 - x0;
+      b.h = y1 - y0;
+      return b;
+    };
+    void add(uint16_t x, uint16_t y)
+    {
+      // consecutive pixels mostly hit the same box
+      if ((_count > _last) && (x >= _x0[_last]) && (x < _x1[_last]) && (y >= _y0[_last]) && (y < _y1[_last])) return;
+      add(x, y, 1, 1);
+    };
+    void add(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+    {
+      if ((w == 0) || (h == 0)) return;
+      uint16_t x0 = x & ~(_align - 1);
+      uint16_t x1 = (x + w + _align - 1) & ~(_align - 1);
+      uint16_t y1 = y + h;
+      // merge with a box it overlaps or nearly touches
+      for (uint8_t i = 0; i < _count; i++)
+      {
+        if ((x0 <= _x1[i]) && (x1 >= _x0[i]) && (y <= _y1[i] + ROW_GAP) && (y1 + ROW_GAP >= _y0[i]))
+        {
+          _merge(i, x0, y, x1, y1);
+          return;
+        }
+      }
+      if (_count < MAX_BOXES)
+      {
+        _x0[_count] = x0;
+        _y0[_count] = y;
+        _x1[_count] = x1;
+        _y1[_count] = y1;
+        _last = _count++;
+        return;
+      }
+      uint8_t best = 0;
+      uint32_t best_growth = 0xFFFFFFFF;
+      for (uint8_t i = 0; i < _count; i++)
+      {
+        uint32_t area = uint32_t(_x1[i] - _x0[i]) * (_y1[i] - _y0[i]);
+        uint32_t merged = uint32_t(_max(x1, _x1[i]) - _min(x0, _x0[i])) * (_max(y1, _y1[i]) - _min(y, _y0[i]));
+        if (merged - area < best_growth)
+        {
+          best_growth = merged - area;
+          best = i;
+        }
+      }
+      _merge(best, x0, y, x1, y1);
+    };
+  private:
+    static inline uint16_t _min(uint16_t a, uint16_t b)
+    {
+      return (a < b ? a : b);
+    };
+    static inline uint16_t _max(uint16_t a, uint16_t b)
+    {
+      return (a > b ? a : b);
+    };
+    void _merge(uint8_t i, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+    {
+      _x0[i] = _min(_x0[i], x0);
+      _y0[i] = _min(_y0[i], y0);
+      _x1[i] = _max(_x1[i], x1);
+      _y1[i] = _max(_y1[i], y1);
+      _last = i;
+      // the grown box may now overlap others
+      for (uint8_t j = 0; j < _count; j++)
+      {
+        if ((j == i) || (_x0[i] > _x1[j]) || (_x1[i] < _x0[j]) || (_y0[i] > _y1[j]) || (_y1[i] < _y0[j])) continue;
+        uint8_t k = _min(i, j), l = _max(i, j);
+        _x0[k] = _min(_x0[i], _x0[j]);
+        _y0[k] = _min(_y0[i], _y0[j]);
+        _x1[k] = _max(_x1[i], _x1[j]);
+        _y1[k] = _max(_y1[i], _y1[j]);
+        _count--;
+        _x0[l] = _x0[_count];
+        _y0[l] = _y0[_count];
+        _x1[l] = _x1[_count];
+        _y1[l] = _y1[_count];
+        _merge(k, _x0[k], _y0[k], _x1[k], _y1[k]);
+        return;
+      }
+    };
+    uint8_t _align, _count, _last;
+    uint16_t _x0[MAX_BOXES], _y0[MAX_BOXES], _x1[MAX_BOXES], _y1[MAX_BOXES];
+};
+
+#endif
@@ -0,0 +1,172 @@
+// Display list of GFX drawing calls, recorded once and played back to a display.
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#include "GxEPD2_DisplayList.h"
+
+void GxEPD2_DisplayList::drawPixel(int16_t x, int16_t y, uint16_t color, GxEPD2_EPD::writeMode mode)
+{
+  Command& c = _add(PIXEL, color, x, y);
+  c.mode = mode;
+  _bound(c, x, y, x, y);
+}
+
+void GxEPD2_DisplayList::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, GxEPD2_EPD::writeMode mode)
+{
+  if ((w == 0) || (h == 0)) return;
+  Command& c = _add(FILL_RECT, color, x, y, w, h);
+  c.mode = mode;
+  _bound(c, x, y, x + w + (w > 0 ? -1 : 1), y + h + (h > 0 ? -1 : 1));
+}
+
+void GxEPD2_DisplayList::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color, GxEPD2_EPD::writeMode mode)
+{
+  fillRect(x, y, w, 1, color, mode);
+}
+
+void GxEPD2_DisplayList::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color, GxEPD2_EPD::writeMode mode)
+{
+  fillRect(x, y, 1, h, color, mode);
+}
+
+void GxEPD2_DisplayList::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color, GxEPD2_EPD::writeMode mode)
+{
+  Command& c = _add(LINE, color, x0, y0, x1, y1);
+  c.mode = mode;
+  _bound(c, x0, y0, x1, y1);
+}
+
+void GxEPD2_DisplayList::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  // the edges as GFX::drawRect() fills them, e.g. w = 0 still draws columns x - 1 and x
+  Command& c = _add(RECT, color, x, y, w, h);
+  _include(c, x, y, w, 1);
+  _include(c, x, y + h - 1, w, 1);
+  _include(c, x, y, 1, h);
+  _include(c, x + w - 1, y, 1, h);
+}
+
+void GxEPD2_DisplayList::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+  _bound(_add(CIRCLE, color, x0, y0, r), x0 - r, y0 - r, x0 + r, y0 + r);
+}
+
+void GxEPD2_DisplayList::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+  _bound(_add(FILL_CIRCLE, color, x0, y0, r), x0 - r, y0 - r, x0 + r, y0 + r);
+}
+
+void GxEPD2_DisplayList::drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color)
+{
+  Command& c = _add(ROUND_RECT, color, x, y, w, h, r);
+  // as GFX::drawRoundRect(): the radius is clipped, the corners stay inside the rect and are drawn only for r > 0
+  int16_t max_radius = _min(w, h) / 2;
+  if (r > max_radius) r = max_radius;
+  _include(c, x + r, y, w - 2 * r, 1);
+  _include(c, x + r, y + h - 1, w - 2 * r, 1);
+  _include(c, x, y + r, 1, h - 2 * r);
+  _include(c, x + w - 1, y + r, 1, h - 2 * r);
+  if (r > 0) _include(c, x, y, w, h);
+}
+
+void GxEPD2_DisplayList::fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color)
+{
+  Command& c = _add(FILL_ROUND_RECT, color, x, y, w, h, r);
+  // as GFX::fillRoundRect()
+  int16_t max_radius = _min(w, h) / 2;
+  if (r > max_radius) r = max_radius;
+  _include(c, x + r, y, w - 2 * r, h);
+  if (r > 0) _include(c, x, y, w, h);
+}
+
+void GxEPD2_DisplayList::drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
+{
+  Command& c = _add(TRIANGLE, color, x0, y0, x1, y1, x2, y2);
+  _bound(c, x0, y0, x1, y1);
+  _bound(c, _min(c.x0, x2), _min(c.y0, y2), _max(c.x1 - 1, x2), _max(c.y1 - 1, y2));
+}
+
+void GxEPD2_DisplayList::fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
+{
+  Command& c = _add(FILL_TRIANGLE, color, x0, y0, x1, y1, x2, y2);
+  _bound(c, x0, y0, x1, y1);
+  _bound(c, _min(c.x0, x2), _min(c.y0, y2), _max(c.x1 - 1, x2), _max(c.y1 - 1, y2));
+}
+
+void GxEPD2_DisplayList::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color)
+{
+  Command& c = _add(BITMAP, color, x, y, w, h);
+  c.data = bitmap;
+  _include(c, x, y, w, h);
+}
+
+void GxEPD2_DisplayList::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, uint16_t bg)
+{
+  Command& c = _add(BITMAP_BG, color, x, y, w, h);
+  c.data = bitmap;
+  c.bg = bg;
+  _include(c, x, y, w, h);
+}
+
+void GxEPD2_DisplayList::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y)
+{
+  // the box GFX::drawChar() draws to, with background for the classic font
+  int16_t x0 = x, y0 = y, x1 = x + 6 * size_x - 1, y1 = y + 8 * size_y - 1;
+  if (gfxFont)
+  {
+    if ((c < gfxFont->first) || (c > gfxFont->last)) return;
+    const GFXglyph* glyph = gfxFont->glyph + (c - gfxFont->first);
+    if ((glyph->width == 0) || (glyph->height == 0)) return;
+    x0 = x + glyph->xOffset * size_x;
+    y0 = y + glyph->yOffset * size_y;
+    x1 = x0 + glyph->width * size_x - 1;
+    y1 = y0 + glyph->height * size_y - 1;
+  }
+  // continue the text run of the previous character
+  Command* run = _commands.empty() ? 0 : &_commands.back();
+  if (run && (run->op == TEXT) && (run->data == gfxFont) && (run->color == color) && (run->bg == bg) && (run->size_x == size_x) && (run->size_y == size_y)
+      && (run->a[1] == y) && (x >= run->a[3]) && (x - run->a[3] <= 255) && (run->a[2] < INT16_MAX))
+  {
+    _text.push_back(c);
+    _text.push_back(x - run->a[3]);
+    run->a[2]++;
+    run->a[3] = x;
+    _bound(*run, _min(run->x0, x0), _min(run->y0, y0), _max(run->x1 - 1, x1), _max(run->y1 - 1, y1));
+    return;
+  }
+  Command& cmd = _add(TEXT, color, x, y, 1, x);
+  cmd.bg = bg;
+  cmd.size_x = size_x;
+  cmd.size_y = size_y;
+  cmd.data = gfxFont;
+  cmd.text = _text.size();
+  _text.push_back(c);
+  _text.push_back(0);
+  _bound(cmd, x0, y0, x1, y1);
+}
+
+GxEPD2_DisplayList::Command& GxEPD2_DisplayList::_add(uint8_t op, uint16_t color, int16_t a0, int16_t a1, int16_t a2, int16_t a3, int16_t a4, int16_t a5)
+{
+  Command c = {op, GxEPD2_EPD::OVERWRITE, 1, 1, color, 0, {a0, a1, a2, a3, a4, a5}, 0, 0, 0, 0, 0, 0};
+  _commands.push_back(c);
+  return _commands.back();
+}
+
+void GxEPD2_DisplayList::_bound(Command& c, int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+{
+  c.x0 = _min(x0, x1);
+  c.y0 = _min(y0, y1);
+  c.x1 = _max(x0, x1) + 1;
+  c.y1 = _max(y0, y1) + 1;
+}
+
+void GxEPD2_DisplayList::_include(Command& c, int16_t x, int16_t y, int16_t w, int16_t h)
+{
+  if ((w <= 0) || (h <= 0)) return;
+  if (c.x0 >= c.x1) _bound(c, x, y, x + w - 1, y + h - 1); // nothing drawn yet
+  else _bound(c, _min(c.x0, x), _min(c.y0, y), _max(c.x1 - 1, x + w - 1), _max(c.y1 - 1, y + h - 1));
+}
@@ -0,0 +1,143 @@
+// Display list of GFX drawing calls, recorded once and played back to a display, e.g. once for each page.
+// The list is a GFX of the display's size: draw to it as to the display, with the display's rotation.
+// Lines, rects, circles, triangles, bitmaps and text are kept as commands; other GFX calls are kept
+// as the pixels and rects they draw. Characters drawn one after the other on a line are kept as one
+// text run. Bitmaps and fonts are kept by pointer, they must stay valid while the list is in use.
+// Each command has a bounding box, playback to a page skips commands outside the page.
+//
+// usage: GxEPD2_DisplayList list(GxEPD2_750_T7::WIDTH, GxEPD2_750_T7::HEIGHT); list.setRotation(display.getRotation());
+//        list.drawLine(...); list.print(...); display.drawPaged(list);
+// or, for paged drawing with firstPage()/nextPage() that runs the drawing code only once:
+//        display.setDisplayList(&list); display.firstPage(); do { ... } while (display.nextPage());
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#ifndef _GxEPD2_DisplayList_H_
+#define _GxEPD2_DisplayList_H_
+
+#include <vector>
+#include "gfx/GFX_Root.h"
+
+class GxEPD2_DisplayList : public GFX
+{
+  public:
+    enum Op
+    {
+      PIXEL, FILL_RECT, LINE, RECT, CIRCLE, FILL_CIRCLE, ROUND_RECT, FILL_ROUND_RECT, TRIANGLE, FILL_TRIANGLE, BITMAP, BITMAP_BG, TEXT
+    };
+    struct Command
+    {
+      uint8_t op; // Op
+      uint8_t mode; // GxEPD2_EPD::writeMode of PIXEL, FILL_RECT and LINE
+      uint8_t size_x, size_y; // TEXT
+      uint16_t color, bg; // bg of BITMAP_BG and TEXT
+      int16_t a[6]; // the arguments of the GFX call in order, up to the color; TEXT: x, y, number of characters, x of the last one
+      int16_t x0, y0, x1, y1; // bounding box, x1 and y1 exclusive
+      const void* data; // BITMAP: the bitmap, TEXT: the GFXfont, 0 for the classic font
+      uint32_t text; // TEXT: index of the first character in the text pool
+    };
+    // w, h: WIDTH and HEIGHT of the display
+    GxEPD2_DisplayList(int16_t w, int16_t h) : GFX(w, h) {};
+    void clear()
+    {
+      _commands.clear();
+      _text.clear();
+    };
+    uint32_t size() const
+    {
+      return _commands.size();
+    };
+    const Command& command(uint32_t i) const
+    {
+      return _commands[i];
+    };
+    // draws the list to target, a display or any GFX; the font of the target is kept
+    template <class T> void play(T& target) const
+    {
+      play(target, INT16_MIN, INT16_MIN, INT16_MAX, INT16_MAX);
+    };
+    // draws the commands that touch x0..x1 - 1, y0..y1 - 1 to target, e.g. the part of the display in its page buffer
+    template <class T> void play(T& target, int16_t x0, int16_t y0, int16_t x1, int16_t y1) const
+    {
+      const GFXfont* font = target.getFont();
+      for (uint32_t i = 0; i < _commands.size(); i++)
+      {
+        const Command& c = _commands[i];
+        if ((c.x1 <= x0) || (c.x0 >= x1) || (c.y1 <= y0) || (c.y0 >= y1)) continue;
+        _play(target, c);
+      }
+      target.setFont(font);
+    };
+    // recorded GFX calls
+    void drawPixel(int16_t x, int16_t y, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE);
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE);
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE);
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE);
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color, GxEPD2_EPD::writeMode mode = GxEPD2_EPD::OVERWRITE);
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+    void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+    void drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color);
+    void fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color);
+    void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+    void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+    void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color);
+    void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, uint16_t bg);
+    using GFX::drawChar;
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y);
+  private:
+    static inline int16_t _min(int16_t a, int16_t b)
+    {
+      return (a < b ? a : b);
+    };
+    static inline int16_t _max(int16_t a, int16_t b)
+    {
+      return (a > b ? a : b);
+    };
+    Command& _add(uint8_t op, uint16_t color, int16_t a0 = 0, int16_t a1 = 0, int16_t a2 = 0, int16_t a3 = 0, int16_t a4 = 0, int16_t a5 = 0);
+    // sets the bounding box of c to the corners x0, y0 and x1, y1, inclusive, in any order
+    static void _bound(Command& c, int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+    // adds the rect x, y, w, h to the bounding box of c as GFX fills it: not at all if w or h is not positive
+    static void _include(Command& c, int16_t x, int16_t y, int16_t w, int16_t h);
+    template <class T> void _play(T& target, const Command& c) const
+    {
+      const int16_t* a = c.a;
+      GxEPD2_EPD::writeMode mode = GxEPD2_EPD::writeMode(c.mode);
+      switch (c.op)
+      {
+        case PIXEL: target.drawPixel(a[0], a[1], c.color, mode); break;
+        case FILL_RECT: target.fillRect(a[0], a[1], a[2], a[3], c.color, mode); break;
+        case LINE: target.drawLine(a[0], a[1], a[2], a[3], c.color, mode); break;
+        case RECT: target.drawRect(a[0], a[1], a[2], a[3], c.color); break;
+        case CIRCLE: target.drawCircle(a[0], a[1], a[2], c.color); break;
+        case FILL_CIRCLE: target.fillCircle(a[0], a[1], a[2], c.color); break;
+        case ROUND_RECT: target.drawRoundRect(a[0], a[1], a[2], a[3], a[4], c.color); break;
+        case FILL_ROUND_RECT: target.fillRoundRect(a[0], a[1], a[2], a[3], a[4], c.color); break;
+        case TRIANGLE: target.drawTriangle(a[0], a[1], a[2], a[3], a[4], a[5], c.color); break;
+        case FILL_TRIANGLE: target.fillTriangle(a[0], a[1], a[2], a[3], a[4], a[5], c.color); break;
+        case BITMAP: target.drawBitmap(a[0], a[1], (const uint8_t*)c.data, a[2], a[3], c.color); break;
+        case BITMAP_BG: target.drawBitmap(a[0], a[1], (const uint8_t*)c.data, a[2], a[3], c.color, c.bg); break;
+        case TEXT:
+          {
+            if (target.getFont() != c.data) target.setFont((const GFXfont*)c.data);
+            // character and x advance from the previous character, in pairs
+            const uint8_t* t = &_text[c.text];
+            int16_t x = a[0];
+            for (int16_t i = 0; i < a[2]; i++, t += 2)
+            {
+              x += t[1];
+              target.drawChar(x, a[1], t[0], c.color, c.bg, c.size_x, c.size_y);
+            }
+          }
+          break;
+      }
+    };
+    std::vector<Command> _commands;
+    std::vector<uint8_t> _text; // text pool
+};
+
+#endif
@@ -0,0 +1,200 @@
+// Conversion of 8 bit per channel images to the colors of e-paper panels, one row at a time.
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#include <new>
+#include <string.h>
+#include "GxEPD2_Dither.h"
+#include "GxEPD2.h"
+
+const GxEPD2_Dither::Palette GxEPD2_Dither::MONO =
+{
+  2, {0, 255}, {0, 255}, {0, 255}, {GxEPD_BLACK, GxEPD_WHITE}
+};
+const GxEPD2_Dither::Palette GxEPD2_Dither::BLACK_RED =
+{
+  3, {0, 255, 255}, {0, 255, 0}, {0, 255, 0}, {GxEPD_BLACK, GxEPD_WHITE, GxEPD_RED}
+};
+const GxEPD2_Dither::Palette GxEPD2_Dither::BLACK_YELLOW =
+{
+  3, {0, 255, 255}, {0, 255, 255}, {0, 255, 0}, {GxEPD_BLACK, GxEPD_WHITE, GxEPD_YELLOW}
+};
+const GxEPD2_Dither::Palette GxEPD2_Dither::SEVEN_COLOR =
+{
+  7, {0, 255, 0, 0, 255, 255, 255}, {0, 255, 255, 0, 0, 255, 128}, {0, 255, 0, 255, 0, 0, 0},
+  {GxEPD_BLACK, GxEPD_WHITE, GxEPD_GREEN, GxEPD_BLUE, GxEPD_RED, GxEPD_YELLOW, GxEPD_ORANGE}
+};
+
+// 8 x 8 Bayer matrix, 0..63
+static const uint8_t bayer[8][8] =
+{
+  { 0, 32,  8, 40,  2, 34, 10, 42},
+  {48, 16, 56, 24, 50, 18, 58, 26},
+  {12, 44,  4, 36, 14, 46,  6, 38},
+  {60, 28, 52, 20, 62, 30, 54, 22},
+  { 3, 35, 11, 43,  1, 33,  9, 41},
+  {51, 19, 59, 27, 49, 17, 57, 25},
+  {15, 47,  7, 39, 13, 45,  5, 37},
+  {63, 31, 55, 23, 61, 29, 53, 21}
+};
+
+static inline int16_t clamp8(int16_t v)
+{
+  return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+GxEPD2_Dither::GxEPD2_Dither(const Palette& palette, Method method, uint32_t width) :
+  _palette(palette), _method(method), _width(width), _y(0), _scratch(0), _best(0)
+{
+  uint32_t row = width + 4;
+  _scratch = new (std::nothrow) int16_t[3 * width + 9 * row];
+  _best = new (std::nothrow) int32_t[width];
+  if (!_scratch || !_best)
+  {
+    delete[] _scratch;
+    delete[] _best;
+    _scratch = 0;
+    _best = 0;
+    return;
+  }
+  memset(_scratch, 0, (3 * width + 9 * row) * sizeof(int16_t));
+  for (uint8_t c = 0; c < 3; c++)
+  {
+    for (uint8_t i = 0; i < 3; i++) _err[c][i] = _scratch + 3 * width + (c * 3 + i) * row;
+  }
+}
+
+GxEPD2_Dither::~GxEPD2_Dither()
+{
+  delete[] _scratch;
+  delete[] _best;
+}
+
+void GxEPD2_Dither::row(const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* index)
+{
+  if (!_scratch) return;
+  int16_t* sr = _scratch;
+  int16_t* sg = sr + _width;
+  int16_t* sb = sg + _width;
+  switch (_method)
+  {
+    case FLOYD_STEINBERG:
+    case ATKINSON:
+      _diffuse(r, g, b, index);
+      break;
+    case BAYER:
+      {
+        // threshold -126..126, about one step between 0 and 255
+        const uint8_t* m = bayer[_y & 7];
+        for (uint32_t x = 0; x < _width; x++)
+        {
+          int16_t t = ((2 * m[x & 7] - 63) * 255) / 128;
+          sr[x] = r[x] + t;
+          sg[x] = g[x] + t;
+          sb[x] = b[x] + t;
+        }
+        _nearestRow(sr, sg, sb, index);
+      }
+      break;
+    default:
+      for (uint32_t x = 0; x < _width; x++)
+      {
+        sr[x] = r[x];
+        sg[x] = g[x];
+        sb[x] = b[x];
+      }
+      _nearestRow(sr, sg, sb, index);
+      break;
+  }
+  _y++;
+}
+
+// weighted squared distance, green counts most, blue least
+uint8_t GxEPD2_Dither::_nearest(int16_t r, int16_t g, int16_t b) const
+{
+  uint8_t best = 0;
+  int32_t best_d = INT32_MAX;
+  for (uint8_t k = 0; k < _palette.count; k++)
+  {
+    int32_t dr = r - _palette.r[k], dg = g - _palette.g[k], db = b - _palette.b[k];
+    int32_t d = 3 * dr * dr + 4 * dg * dg + 2 * db * db;
+    if (d < best_d)
+    {
+      best_d = d;
+      best = k;
+    }
+  }
+  return best;
+}
+
+// palette colors in the outer loop, pixels in the inner one
+void GxEPD2_Dither::_nearestRow(const int16_t* r, const int16_t* g, const int16_t* b, uint8_t* index)
+{
+  for (uint32_t x = 0; x < _width; x++)
+  {
+    _best[x] = INT32_MAX;
+    index[x] = 0;
+  }
+  for (uint8_t k = 0; k < _palette.count; k++)
+  {
+    int32_t pr = _palette.r[k], pg = _palette.g[k], pb = _palette.b[k];
+    for (uint32_t x = 0; x < _width; x++)
+    {
+      int32_t dr = r[x] - pr, dg = g[x] - pg, db = b[x] - pb;
+      int32_t d = 3 * dr * dr + 4 * dg * dg + 2 * db * db;
+      bool nearer = d < _best[x];
+      _best[x] = nearer ? d : _best[x];
+      index[x] = nearer ? k : index[x];
+    }
+  }
+}
+
+void GxEPD2_Dither::_diffuse(const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* index)
+{
+  const uint8_t* in[3] = {r, g, b};
+  const uint8_t* pal[3] = {_palette.r, _palette.g, _palette.b};
+  int16_t v[3];
+  for (uint32_t x = 0; x < _width; x++)
+  {
+    // error rows are offset by the margin of 2
+    for (uint8_t c = 0; c < 3; c++) v[c] = clamp8(in[c][x] + _err[c][0][x + 2]);
+    uint8_t k = _nearest(v[0], v[1], v[2]);
+    index[x] = k;
+    for (uint8_t c = 0; c < 3; c++)
+    {
+      int16_t e = v[c] - pal[c][k];
+      int16_t* e0 = _err[c][0] + x + 2;
+      int16_t* e1 = _err[c][1] + x + 2;
+      if (_method == FLOYD_STEINBERG)
+      {
+        e0[1] += e * 7 / 16;
+        e1[-1] += e * 3 / 16;
+        e1[0] += e * 5 / 16;
+        e1[1] += e / 16;
+      }
+      else
+      {
+        e /= 8;
+        e0[1] += e;
+        e0[2] += e;
+        e1[-1] += e;
+        e1[0] += e;
+        e1[1] += e;
+        _err[c][2][x + 2] += e;
+      }
+    }
+  }
+  // next row
+  for (uint8_t c = 0; c < 3; c++)
+  {
+    int16_t* done = _err[c][0];
+    _err[c][0] = _err[c][1];
+    _err[c][1] = _err[c][2];
+    _err[c][2] = done;
+    memset(done, 0, (_width + 4) * sizeof(int16_t));
+  }
+}
@@ -0,0 +1,64 @@
+// Conversion of 8 bit per channel images to the colors of e-paper panels, one row at a time.
+// Used by BMPfile to load grayscale and RGB bitmaps into the buffers of GxEPD2_BW, GxEPD2_3C and GxEPD2_7C.
+//
+// Rows are planar (separate r, g and b arrays), so nearest color and ordered dithering are plain loops
+// over x that the compiler can vectorize; error diffusion carries its error forward and stays serial.
+// Rows must be given top to bottom, error diffusion spreads down and to the right.
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#ifndef _GxEPD2_Dither_H_
+#define _GxEPD2_Dither_H_
+
+#include <stdint.h>
+
+class GxEPD2_Dither
+{
+  public:
+    enum Method
+    {
+      NEAREST, // nearest color, no dithering
+      BAYER, // ordered, 8 x 8 Bayer matrix; stable under small changes of the image
+      FLOYD_STEINBERG, // error diffusion, all of the error
+      ATKINSON // error diffusion, 3/4 of the error; more contrast, less noise in flat areas
+    };
+    static const uint8_t MAX_COLORS = 7;
+    struct Palette
+    {
+      uint8_t count;
+      uint8_t r[MAX_COLORS], g[MAX_COLORS], b[MAX_COLORS];
+      uint16_t color[MAX_COLORS]; // GxEPD_BLACK etc.
+    };
+    static const Palette MONO; // black, white
+    static const Palette BLACK_RED; // black, white, red
+    static const Palette BLACK_YELLOW; // black, white, yellow
+    static const Palette SEVEN_COLOR; // black, white, green, blue, red, yellow, orange of GxEPD2_565c
+    // width: pixels of a row
+    GxEPD2_Dither(const Palette& palette, Method method, uint32_t width);
+    ~GxEPD2_Dither();
+    // false if the buffers could not be allocated
+    bool valid() const
+    {
+      return _scratch != 0;
+    };
+    // converts the next row to palette indexes
+    void row(const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* index);
+  private:
+    GxEPD2_Dither(const GxEPD2_Dither&);
+    GxEPD2_Dither& operator=(const GxEPD2_Dither&);
+    uint8_t _nearest(int16_t r, int16_t g, int16_t b) const;
+    void _nearestRow(const int16_t* r, const int16_t* g, const int16_t* b, uint8_t* index);
+    void _diffuse(const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* index);
+    const Palette& _palette;
+    Method _method;
+    uint32_t _width, _y;
+    int16_t* _scratch; // r, g, b rows of the image with threshold, then the error rows
+    int32_t* _best; // distance of the nearest color so far
+    int16_t* _err[3][3]; // error of channel c for rows y, y + 1, y + 2, with a margin of 2 pixels each side
+};
+
+#endif
@@ -25,17 +25,35 @@
 RPI_SPI GxEPD2_EPD::SPI;
 
 GxEPD2_EPD::GxEPD2_EPD(int8_t cs, int8_t dc, int8_t rst, int8_t busy, int8_t busy_level, uint32_t busy_timeout,
-                       uint16_t w, uint16_t h, GxEPD2::Panel p, bool c, bool pu, bool fpu) :
+                       uint16_t w, uint16_t h, GxEPD2::Panel p, bool c, bool pu, bool fpu, uint32_t spi_clock) :
   WIDTH(w), HEIGHT(h), panel(p), hasColor(c), hasPartialUpdate(pu), hasFastPartialUpdate(fpu),
   _cs(cs), _dc(dc), _rst(rst), _busy(busy), _busy_level(busy_level), _busy_timeout(busy_timeout), _diag_enabled(false),
-  _spi_settings(4000000, MSBFIRST, SPI_MODE0)
+  _spi_settings(spi_clock, MSBFIRST, SPI_MODE0), _initial_write(this, true), _initial_refresh(this, true),
+  _power_is_on(this, false), _using_partial_mode(this, false), _hibernating(this, false),
+  _transport(this, &_spi_transport), _custom_transport(0)
 {
-  _initial_write = true;
-  _initial_refresh = true;
-  _power_is_on = false;
-  _using_partial_mode = false;
-  _hibernating = false;
   _reset_duration = 20;
+#ifdef RPI
+  _tx_count = 0;
+#endif
+}
+
+GxEPD2_EPD::GxEPD2_EPD(const GxEPD2_EPD& other) :
+  WIDTH(other.WIDTH), HEIGHT(other.HEIGHT), panel(other.panel), hasColor(other.hasColor),
+  hasPartialUpdate(other.hasPartialUpdate), hasFastPartialUpdate(other.hasFastPartialUpdate),
+  _cs(other._cs), _dc(other._dc), _rst(other._rst), _busy(other._busy), _busy_level(other._busy_level),
+  _busy_timeout(other._busy_timeout), _diag_enabled(other._diag_enabled), _pulldown_rst_mode(other._pulldown_rst_mode),
+  _spi_settings(other._spi_settings), _initial_write(this, other._initial_write), _initial_refresh(this, other._initial_refresh),
+  _power_is_on(this, other._power_is_on), _using_partial_mode(this, other._using_partial_mode), _hibernating(this, other._hibernating),
+  _reset_duration(other._reset_duration), _spi_transport(other._spi_transport),
+  _transport(this, other._custom_transport ? other._custom_transport : &_spi_transport), _custom_transport(other._custom_transport)
+#ifdef GxEPD2_STATS
+  , _stats(other._stats)
+#endif
+{
+#ifdef RPI
+  _tx_count = 0;
+#endif
 }
 
 void GxEPD2_EPD::init(uint32_t serial_diag_bitrate)
@@ -43,8 +61,26 @@ void GxEPD2_EPD::init(uint32_t serial_diag_bitrate)
   init(serial_diag_bitrate, true, 20, false);
 }
 
+GxEPD2_EPD::~GxEPD2_EPD()
+{
+  _waitAsync();
+}
+
+void GxEPD2_EPD::setTransport(GxEPD2_Transport* transport)
+{
+  _custom_transport = transport;
+  _transport = transport ? transport : &_spi_transport;
+}
+
+void GxEPD2_EPD::setSpiClock(uint32_t clock)
+{
+  _waitAsync();
+  _spi_settings = SPISettings(clock, MSBFIRST, SPI_MODE0);
+}
+
 void GxEPD2_EPD::init(uint32_t serial_diag_bitrate, bool initial, uint16_t reset_duration, bool pulldown_rst_mode)
 {
+  _waitAsync();
   _initial_write = initial;
   _initial_refresh = initial;
   _pulldown_rst_mode = pulldown_rst_mode;
@@ -52,9 +88,6 @@ void GxEPD2_EPD::init(uint32_t serial_diag_bitrate, bool initial, uint16_t reset
   _using_partial_mode = false;
   _hibernating = false;
   _reset_duration = reset_duration;
-  #ifdef RPI
-  SPI.begin();
-  #endif
   if (serial_diag_bitrate > 0)
   {
     #ifdef RPI
@@ -63,26 +96,14 @@ void GxEPD2_EPD::init(uint32_t serial_diag_bitrate, bool initial, uint16_t reset
     #endif
     _diag_enabled = true;
   }
-  if (_cs >= 0)
-  {
-    digitalWrite(_cs, HIGH);
-    pinMode(_cs, OUTPUT);
-  }
-  if (_dc >= 0)
-  {
-    digitalWrite(_dc, HIGH);
-    pinMode(_dc, OUTPUT);
-  }
+  _transport->begin(_cs, _dc, _busy, _busy_level);
   _reset();
-  if (_busy >= 0)
-  {
-    pinMode(_busy, INPUT);
-  }
-  SPI.begin();
 }
 
 void GxEPD2_EPD::_reset()
 {
+  _waitAsync();
+  GxEPD2_STATS_TIME(RESET);
   if (_rst >= 0)
   {
     if (_pulldown_rst_mode)
@@ -109,19 +130,14 @@ void GxEPD2_EPD::_reset()
 
 void GxEPD2_EPD::_waitWhileBusy(const char* comment, uint16_t busy_time)
 {
+  GxEPD2_STATS_TIME(BUSY);
   if (_busy >= 0)
   {
     delay(1); // add some margin to become active
     unsigned long start = micros();
-    while (1)
+    if (!_transport->waitWhileBusy(_busy_timeout))
     {
-      if (digitalRead(_busy) != _busy_level) break;
-      delay(1);
-      if (micros() - start > _busy_timeout)
-      {
-        Debug("Busy Timeout!\n");
-        break;
-      }
+      Debug("Busy Timeout!\n");
     }
     if (comment)
     {
@@ -145,115 +161,241 @@ void GxEPD2_EPD::_waitWhileBusy(const char* comment, uint16_t busy_time)
 
 void GxEPD2_EPD::_writeCommand(uint8_t c)
 {
-  SPI.beginTransaction(_spi_settings);
-  if (_dc >= 0) digitalWrite(_dc, LOW);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
-  SPI.transfer(c);
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  if (_dc >= 0) digitalWrite(_dc, HIGH);
-  SPI.endTransaction();
+  GxEPD2_STATS_COMMAND(c);
+  _transport->beginTransaction(_spi_settings);
+  _transport->writeCommand(c);
+  _transport->endTransaction();
 }
 
 void GxEPD2_EPD::_writeData(uint8_t d)
 {
-  SPI.beginTransaction(_spi_settings);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
-  SPI.transfer(d);
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  GxEPD2_STATS_DATA(1);
+  _transport->beginTransaction(_spi_settings);
+  _transport->transfer(d);
+  _transport->endTransaction();
 }
 
-void GxEPD2_EPD::_writeData(const uint8_t* data, uint16_t n)
+void GxEPD2_EPD::_writeData(const uint8_t* data, uint16_t n, bool invert, bool pgm)
 {
-  SPI.beginTransaction(_spi_settings);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
-  for (uint16_t i = 0; i < n; i++)
-  {
-    SPI.transfer(*data++);
-  }
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _transport->beginTransaction(_spi_settings);
+  _transfer(data, n, invert, pgm);
+  _transport->endTransaction();
+}
+
+void GxEPD2_EPD::_writeDataFill(uint8_t value, uint32_t n)
+{
+  _transport->beginTransaction(_spi_settings);
+  _transferFill(value, n);
+  _transport->endTransaction();
 }
 
 void GxEPD2_EPD::_writeDataPGM(const uint8_t* data, uint16_t n, int16_t fill_with_zeroes)
 {
-  SPI.beginTransaction(_spi_settings);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
-  for (uint16_t i = 0; i < n; i++)
-  {
-    SPI.transfer(pgm_read_byte(&*data++));
-  }
+  static const uint8_t zeroes[GxEPD2_BLOCK_SIZE < 64 ? GxEPD2_BLOCK_SIZE : 64] = {0};
+  _transport->beginTransaction(_spi_settings);
+  _transfer(data, n, false, true);
   while (fill_with_zeroes > 0)
   {
-    SPI.transfer((uint8_t)0x00);
-    fill_with_zeroes--;
+    uint16_t k = gx_uint16_min(fill_with_zeroes, sizeof(zeroes));
+    GxEPD2_STATS_DATA(k);
+    _transport->writeData(zeroes, k);
+    fill_with_zeroes -= k;
   }
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _transport->endTransaction();
 }
 
 void GxEPD2_EPD::_writeDataPGM_sCS(const uint8_t* data, uint16_t n, int16_t fill_with_zeroes)
 {
-  SPI.beginTransaction(_spi_settings);
+  GxEPD2_STATS_DATA(n + (fill_with_zeroes > 0 ? fill_with_zeroes : 0));
   for (uint8_t i = 0; i < n; i++)
   {
-    if (_cs >= 0) digitalWrite(_cs, LOW);
-    SPI.transfer(pgm_read_byte(&*data++));
-    if (_cs >= 0) digitalWrite(_cs, HIGH);
+    _transport->beginTransaction(_spi_settings);
+    _transport->transfer(pgm_read_byte(&*data++));
+    _transport->endTransaction();
   }
   while (fill_with_zeroes > 0)
   {
-    if (_cs >= 0) digitalWrite(_cs, LOW);
-    SPI.transfer((uint8_t)0x00);
+    _transport->beginTransaction(_spi_settings);
+    _transport->transfer((uint8_t)0x00);
     fill_with_zeroes--;
-    if (_cs >= 0) digitalWrite(_cs, HIGH);
+    _transport->endTransaction();
   }
-  SPI.endTransaction();
 }
 
 void GxEPD2_EPD::_writeCommandData(const uint8_t* pCommandData, uint8_t datalen)
 {
-  SPI.beginTransaction(_spi_settings);
-  if (_dc >= 0) digitalWrite(_dc, LOW);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
-  SPI.transfer(*pCommandData++);
-  if (_dc >= 0) digitalWrite(_dc, HIGH);
-  for (uint8_t i = 0; i < datalen - 1; i++)  // sub the command
-  {
-    SPI.transfer(*pCommandData++);
-  }
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _transport->beginTransaction(_spi_settings);
+  GxEPD2_STATS_COMMAND(*pCommandData);
+  _transport->writeCommand(*pCommandData++);
+  _transfer(pCommandData, datalen - 1);  // sub the command
+  _transport->endTransaction();
 }
 
 void GxEPD2_EPD::_writeCommandDataPGM(const uint8_t* pCommandData, uint8_t datalen)
 {
-  SPI.beginTransaction(_spi_settings);
-  if (_dc >= 0) digitalWrite(_dc, LOW);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
-  SPI.transfer(pgm_read_byte(&*pCommandData++));
-  if (_dc >= 0) digitalWrite(_dc, HIGH);
-  for (uint8_t i = 0; i < datalen - 1; i++)  // sub the command
-  {
-    SPI.transfer(pgm_read_byte(&*pCommandData++));
-  }
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _transport->beginTransaction(_spi_settings);
+  GxEPD2_STATS_COMMAND(pgm_read_byte(&*pCommandData));
+  _transport->writeCommand(pgm_read_byte(&*pCommandData++));
+  _transfer(pCommandData, datalen - 1, false, true);  // sub the command
+  _transport->endTransaction();
 }
 
 void GxEPD2_EPD::_startTransfer()
 {
-  SPI.beginTransaction(_spi_settings);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
+  _transport->beginTransaction(_spi_settings);
 }
 
 void GxEPD2_EPD::_transfer(uint8_t value)
 {
-  SPI.transfer(value);
+  GxEPD2_STATS_DATA(1);
+#ifdef RPI
+  _tx_buffer[_tx_count++] = value;
+  if (_tx_count == sizeof(_tx_buffer)) _flushTransfer();
+#else
+  _transport->transfer(value);
+#endif
+}
+
+void GxEPD2_EPD::_transferFill(uint8_t value, uint32_t n)
+{
+  uint8_t block[GxEPD2_BLOCK_SIZE];
+  memset(block, value, n < sizeof(block) ? n : sizeof(block));
+  _flushTransfer();
+  GxEPD2_STATS_DATA(n);
+  GxEPD2_STATS_TIME(TRANSFER);
+  while (n > 0)
+  {
+    uint16_t k = n < sizeof(block) ? n : sizeof(block);
+    _transport->writeData(block, k);
+    n -= k;
+#if defined(ESP8266) || defined(ESP32)
+    yield();
+#endif
+  }
+}
+
+// block transfer of n bytes, e.g. one row of a bitmap, optionally inverted or from PROGMEM
+void GxEPD2_EPD::_transfer(const uint8_t* data, uint16_t n, bool invert, bool pgm)
+{
+#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
+  bool direct = !invert && !pgm;
+#else
+  bool direct = !invert; // PROGMEM is plain memory
+#endif
+  _flushTransfer();
+  GxEPD2_STATS_DATA(n);
+  if (direct)
+  {
+    GxEPD2_STATS_TIME(TRANSFER);
+    _transport->writeData(data, n);
+    return;
+  }
+  uint8_t block[GxEPD2_BLOCK_SIZE];
+  while (n > 0)
+  {
+    uint16_t k = gx_uint16_min(n, sizeof(block));
+    {
+      GxEPD2_STATS_TIME(CONVERT);
+      for (uint16_t i = 0; i < k; i++)
+      {
+#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
+        uint8_t value = pgm ? pgm_read_byte(&data[i]) : data[i];
+#else
+        uint8_t value = data[i];
+#endif
+        block[i] = invert ? ~value : value;
+      }
+    }
+    GxEPD2_STATS_TIME(TRANSFER);
+    _transport->writeData(block, k);
+    data += k;
+    n -= k;
+  }
 }
 
 void GxEPD2_EPD::_endTransfer()
 {
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _flushTransfer();
+  _transport->endTransaction();
+}
+
+void GxEPD2_EPD::_flushTransfer()
+{
+#ifdef RPI
+  if (_tx_count > 0)
+  {
+    GxEPD2_STATS_TIME(TRANSFER);
+    _transport->writeData(_tx_buffer, _tx_count);
+    _tx_count = 0;
+  }
+#endif
+}
+
+#ifdef RPI
+std::shared_future<void> GxEPD2_EPD::refreshAsync(bool partial_update_mode, std::function<void()> done)
+{
+  return runAsync([this, partial_update_mode]()
+  {
+    refresh(partial_update_mode);
+  }, done);
+}
+
+std::shared_future<void> GxEPD2_EPD::refreshAsync(int16_t x, int16_t y, int16_t w, int16_t h, std::function<void()> done)
+{
+  return runAsync([this, x, y, w, h]()
+  {
+    refresh(x, y, w, h);
+  }, done);
+}
+
+std::shared_future<void> GxEPD2_EPD::runAsync(std::function<void()> job, std::function<void()> done)
+{
+  _waitAsync(); // one background operation at a time
+  if (!_async) _async = std::make_shared<AsyncState>();
+  std::shared_ptr<AsyncState> state = _async;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->pending = true;
+    state->worker = std::thread::id(); // controller access waits until the worker is known
+  }
+  std::shared_ptr<std::promise<void>> completion = std::make_shared<std::promise<void>>();
+  std::shared_future<void> result = completion->get_future().share();
+  std::thread([state, job, done, completion]()
+  {
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->worker = std::this_thread::get_id();
+    }
+    std::exception_ptr error;
+    try
+    {
+      job();
+    }
+    catch (...)
+    {
+      error = std::current_exception(); // waiters must not block forever
+    }
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->pending = false;
+    }
+    state->done.notify_all();
+    if (error) completion->set_exception(error);
+    else completion->set_value();
+    if (done) done();
+  }).detach();
+  return result;
+}
+
+void GxEPD2_EPD::waitAsync()
+{
+  if (!_async) return;
+  std::unique_lock<std::mutex> lock(_async->mutex);
+  if (_async->worker == std::this_thread::get_id()) return; // controller access by the background job
+  AsyncState* state = _async.get();
+  state->done.wait(lock, [state]()
+  {
+    return !state->pending;
+  });
 }
+#endif
@@ -18,15 +18,31 @@
 #include <wiringPi.h>   // for delay()
 #endif
 #include "RPI_SPI.h"
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #else
 #include <Arduino.h>
 #include "SPI.h"
 #endif
 
 #include "GxEPD2.h"
+#include "GxEPD2_Transport.h"
+#include "GxEPD2_Stats.h"
 
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
+// largest block sent with one call to the SPI transport, e.g. one row of an image
+#ifdef RPI
+#define GxEPD2_BLOCK_SIZE 4096
+#else
+#define GxEPD2_BLOCK_SIZE 64
+#endif
+
 class GxEPD2_EPD
 {
   public:
@@ -44,9 +60,27 @@ enum writeMode {
 
     // constructor
     GxEPD2_EPD(int8_t cs, int8_t dc, int8_t rst, int8_t busy, int8_t busy_level, uint32_t busy_timeout,
-               uint16_t w, uint16_t h, GxEPD2::Panel p, bool c, bool pu, bool fpu);
+               uint16_t w, uint16_t h, GxEPD2::Panel p, bool c, bool pu, bool fpu, uint32_t spi_clock = 4000000);
+    // copies the settings, e.g. of the driver passed to GxEPD2_BW; selects its own SPI transport, background refreshes are not shared
+    GxEPD2_EPD(const GxEPD2_EPD& other);
+    virtual ~GxEPD2_EPD();
     virtual void init(uint32_t serial_diag_bitrate = 0); // serial_diag_bitrate = 0 : disabled
     virtual void init(uint32_t serial_diag_bitrate, bool initial, uint16_t reset_duration = 20, bool pulldown_rst_mode = false);
+    // use another transport, e.g. GxEPD2_RecordingTransport; call before init(), NULL selects SPI
+    void setTransport(GxEPD2_Transport* transport);
+    // SPI clock for writes, default is the driver's spi_clock; lower it e.g. for long wires
+    virtual void setSpiClock(uint32_t clock);
+#ifdef GxEPD2_STATS
+    // counters and timers since construction or clearStats()
+    const GxEPD2_Stats& stats() const
+    {
+      return _stats;
+    };
+    void clearStats()
+    {
+      _stats.clear();
+    };
+#endif
  #ifdef RPI
 static  RPI_SPI SPI;
    void rpiEpdExit(void);
@@ -99,6 +133,17 @@ static  RPI_SPI SPI;
     virtual void powerOff() = 0; // turns off generation of panel driving voltages, avoids screen fading over time
     virtual void hibernate() = 0; // turns powerOff() and sets controller to deep sleep for minimum power use, ONLY if wakeable by RST (rst >= 0)
     virtual void setPaged() {}; // for GxEPD2_154c paged workaround
+#ifdef RPI
+    // asynchronous refresh: returns at once, the refresh runs in a background thread;
+    // done (optional) is called from that thread on completion, the future becomes ready then too;
+    // any other controller access waits for completion, one background operation at a time
+    std::shared_future<void> refreshAsync(bool partial_update_mode = false, std::function<void()> done = nullptr);
+    std::shared_future<void> refreshAsync(int16_t x, int16_t y, int16_t w, int16_t h, std::function<void()> done = nullptr);
+    // runs job in a background thread, as refreshAsync(); job may use any controller methods;
+    // an exception thrown by job ends the operation, the future rethrows it
+    std::shared_future<void> runAsync(std::function<void()> job, std::function<void()> done = nullptr);
+    void waitAsync(); // waits for completion of a background operation, if any
+#endif
     static inline uint16_t gx_uint16_min(uint16_t a, uint16_t b)
     {
       return (a < b ? a : b);
@@ -108,18 +153,59 @@ static  RPI_SPI SPI;
       return (a > b ? a : b);
     };
   protected:
+    inline void _waitAsync()
+    {
+#ifdef RPI
+      if (_async) waitAsync();
+#endif
+    };
+    // driver state and transport: every access waits for a background operation of this driver first,
+    // so drivers need no waits of their own; the background job itself passes (see waitAsync())
+    template <typename T> class _Guarded
+    {
+      public:
+        _Guarded(GxEPD2_EPD* owner, T value) : _owner(owner), _value(value) {};
+        _Guarded& operator=(const _Guarded& other)
+        {
+          return *this = T(other);
+        };
+        _Guarded& operator=(T value)
+        {
+          _owner->_waitAsync();
+          _value = value;
+          return *this;
+        };
+        operator T() const
+        {
+          _owner->_waitAsync();
+          return _value;
+        };
+        T operator->() const
+        {
+          _owner->_waitAsync();
+          return _value;
+        };
+      private:
+        GxEPD2_EPD* _owner;
+        T _value;
+    };
     void _reset();
     void _waitWhileBusy(const char* comment = 0, uint16_t busy_time = 5000);
     void _writeCommand(uint8_t c);
     void _writeData(uint8_t d);
-    void _writeData(const uint8_t* data, uint16_t n);
+    void _writeData(const uint8_t* data, uint16_t n, bool invert = false, bool pgm = false);
+    void _writeDataFill(uint8_t value, uint32_t n); // n bytes of value, one transaction
     void _writeDataPGM(const uint8_t* data, uint16_t n, int16_t fill_with_zeroes = 0);
     void _writeDataPGM_sCS(const uint8_t* data, uint16_t n, int16_t fill_with_zeroes = 0);
     void _writeCommandData(const uint8_t* pCommandData, uint8_t datalen);
     void _writeCommandDataPGM(const uint8_t* pCommandData, uint8_t datalen);
+    // data phase: CS stays asserted from _startTransfer() to _endTransfer(), single bytes are coalesced into blocks
     void _startTransfer();
     void _transfer(uint8_t value);
+    void _transferFill(uint8_t value, uint32_t n); // n bytes of value
+    void _transfer(const uint8_t* data, uint16_t n, bool invert = false, bool pgm = false);
     void _endTransfer();
+    void _flushTransfer(); // sends coalesced bytes
 #ifdef RPI
     int rpiInit(void);
 #endif
@@ -128,9 +214,29 @@ static  RPI_SPI SPI;
     uint32_t _busy_timeout;
     bool _diag_enabled, _pulldown_rst_mode;
     SPISettings _spi_settings;
-    bool _initial_write, _initial_refresh;
-    bool _power_is_on, _using_partial_mode, _hibernating;
+    _Guarded<bool> _initial_write, _initial_refresh;
+    _Guarded<bool> _power_is_on, _using_partial_mode, _hibernating;
     uint16_t _reset_duration;
+    GxEPD2_SPI_Transport _spi_transport;
+    _Guarded<GxEPD2_Transport*> _transport;
+    GxEPD2_Transport* _custom_transport;
+#ifdef GxEPD2_STATS
+    GxEPD2_Stats _stats;
+#endif
+#ifdef RPI
+    uint8_t _tx_buffer[GxEPD2_BLOCK_SIZE]; // coalesced single byte _transfer()
+    uint16_t _tx_count;
+#endif
+#ifdef RPI
+    struct AsyncState
+    {
+      std::mutex mutex;
+      std::condition_variable done;
+      bool pending = false;
+      std::thread::id worker;
+    };
+    std::shared_ptr<AsyncState> _async;
+#endif
 };
 
 #endif
@@ -0,0 +1,156 @@
+// Images already converted to a display's native layout, kept as files in a cache directory.
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//#define DEBUG
+#include "Debug.h"
+#include "GxEPD2_ImageCache.h"
+
+// file: header, source path, pixel data from data_offset
+struct GxEPD2_ImageCache::Header
+{
+  char magic[4]; // "GXI1"
+  uint32_t data_offset;
+  int64_t mtime_sec, mtime_nsec; // of the source file
+  uint64_t source_size;
+  uint16_t panel;
+  uint8_t layout, variant;
+  uint16_t width, height;
+  uint32_t row_bytes;
+  uint8_t planes, reserved;
+  uint16_t path_length;
+};
+
+static const char magic[4] = {'G', 'X', 'I', '1'};
+
+void GxEPD2_ImageCache::Entry::close()
+{
+  if (_map) munmap(_map, _size);
+  _map = 0;
+  _size = 0;
+  _data = 0;
+  _width = _height = 0;
+  _rowBytes = 0;
+  _planes = 0;
+}
+
+// file name: hash of what selects the entry, but not of the source's state, so a new version replaces the old
+std::string GxEPD2_ImageCache::_name(const Key& key) const
+{
+  uint64_t h = 1469598103934665603ULL; // FNV-1a
+  for (const char* p = key.path; *p; p++) h = (h ^ uint8_t(*p)) * 1099511628211ULL;
+  uint8_t k[4] = {uint8_t(key.panel), uint8_t(key.panel >> 8), key.layout, key.variant};
+  for (uint8_t i = 0; i < 4; i++) h = (h ^ k[i]) * 1099511628211ULL;
+  char name[24];
+  snprintf(name, sizeof(name), "/%016llx.gxi", (unsigned long long)h);
+  return _dir + name;
+}
+
+// the header an entry of key must have for the current source file
+bool GxEPD2_ImageCache::_source(const Key& key, Header& header)
+{
+  struct stat st;
+  if (stat(key.path, &st) != 0) return false;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, magic, sizeof(magic));
+  header.mtime_sec = st.st_mtim.tv_sec;
+  header.mtime_nsec = st.st_mtim.tv_nsec;
+  header.source_size = st.st_size;
+  header.panel = key.panel;
+  header.layout = key.layout;
+  header.variant = key.variant;
+  header.path_length = strlen(key.path);
+  header.data_offset = (sizeof(Header) + header.path_length + 7) & ~7u;
+  return true;
+}
+
+bool GxEPD2_ImageCache::find(const Key& key, Entry& entry) const
+{
+  entry.close();
+  Header expected, header;
+  if (!_source(key, expected)) return false;
+  std::string name = _name(key);
+  int fd = open(name.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || (size_t(st.st_size) < expected.data_offset))
+  {
+    close(fd);
+    return false;
+  }
+  void* map = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) return false;
+  const uint8_t* p = (const uint8_t*)map;
+  memcpy(&header, p, sizeof(header));
+  // same source file and conversion; the rest of the header describes the image
+  bool valid = (memcmp(&header, &expected, offsetof(Header, width)) == 0) && (header.path_length == expected.path_length)
+               && (memcmp(p + sizeof(Header), key.path, header.path_length) == 0)
+               && (uint64_t(header.row_bytes) * header.height * header.planes <= uint64_t(st.st_size) - header.data_offset);
+  if (!valid)
+  {
+    Debug("no cache entry for %s\n", key.path);
+    munmap(map, st.st_size);
+    return false;
+  }
+  entry._map = map;
+  entry._size = st.st_size;
+  entry._data = p + header.data_offset;
+  entry._width = header.width;
+  entry._height = header.height;
+  entry._rowBytes = header.row_bytes;
+  entry._planes = header.planes;
+  return true;
+}
+
+bool GxEPD2_ImageCache::store(const Key& key, uint16_t width, uint16_t height, uint32_t rowBytes, uint8_t planes, const uint8_t* data) const
+{
+  Header header;
+  if (!_source(key, header)) return false;
+  header.width = width;
+  header.height = height;
+  header.row_bytes = rowBytes;
+  header.planes = planes;
+  // write a temporary file of a unique name and rename it, readers never see a partial entry
+  std::string name = _name(key), temp = name + ".XXXXXX";
+  int fd = mkstemp(&temp[0]);
+  if (fd < 0) return false;
+  fchmod(fd, 0644); // mkstemp() creates it 0600
+  FILE* fp = fdopen(fd, "wb");
+  if (!fp)
+  {
+    close(fd);
+    unlink(temp.c_str());
+    return false;
+  }
+  static const uint8_t zeros[8] = {0};
+  size_t bytes = size_t(rowBytes) * height * planes;
+  uint32_t pad = header.data_offset - sizeof(Header) - header.path_length;
+  bool ok = (fwrite(&header, sizeof(header), 1, fp) == 1) && (fwrite(key.path, 1, header.path_length, fp) == header.path_length)
+            && (fwrite(zeros, 1, pad, fp) == pad) && (fwrite(data, 1, bytes, fp) == bytes);
+  ok = (fclose(fp) == 0) && ok;
+  if (ok) ok = rename(temp.c_str(), name.c_str()) == 0;
+  if (!ok)
+  {
+    Debug("can't store cache entry %s\n", name.c_str());
+    unlink(temp.c_str());
+  }
+  return ok;
+}
+
+void GxEPD2_ImageCache::remove(const Key& key) const
+{
+  unlink(_name(key).c_str());
+}
@@ -0,0 +1,96 @@
+// Images already converted to a display's native layout, kept as files in a cache directory.
+//
+// An entry is keyed by the path, modification time and size of the source file, the panel, the layout
+// and a variant (the options of the conversion, e.g. mirror and dithering). Entries of changed source
+// files are no longer found and are replaced when stored again. Entries are mapped into memory, so a
+// cached image goes to the controller from the page cache in one bulk write.
+//
+// Layouts: MONO 1 bit per pixel rows (GxEPD2_BW, also IT8951 drivers).
+// Rows are in display order, top row first, each rowBytes long.
+//
+// usage: GxEPD2_ImageCache cache("/var/cache/epd"); display.setImageCache(&cache); display.streamBmpFile(...);
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#ifndef _GxEPD2_ImageCache_H_
+#define _GxEPD2_ImageCache_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+class GxEPD2_ImageCache
+{
+  public:
+    enum Layout
+    {
+      MONO = 1
+    };
+    struct Key
+    {
+      const char* path; // of the source image
+      uint16_t panel; // GxEPD2::Panel
+      uint8_t layout; // Layout
+      uint8_t variant; // options of the conversion
+    };
+    // a cached image, mapped while the Entry exists
+    class Entry
+    {
+      public:
+        Entry() : _map(0), _size(0), _data(0), _width(0), _height(0), _rowBytes(0), _planes(0) {};
+        ~Entry()
+        {
+          close();
+        };
+        void close();
+        uint16_t width() const
+        {
+          return _width;
+        };
+        uint16_t height() const
+        {
+          return _height;
+        };
+        uint32_t rowBytes() const
+        {
+          return _rowBytes;
+        };
+        uint8_t planes() const
+        {
+          return _planes;
+        };
+        const uint8_t* plane(uint8_t i) const
+        {
+          return _data + uint32_t(i) * _rowBytes * _height;
+        };
+      private:
+        friend class GxEPD2_ImageCache;
+        Entry(const Entry&);
+        Entry& operator=(const Entry&);
+        void* _map;
+        size_t _size;
+        const uint8_t* _data;
+        uint16_t _width, _height;
+        uint32_t _rowBytes;
+        uint8_t _planes;
+    };
+    // dir: an existing, writable directory
+    GxEPD2_ImageCache(const char* dir) : _dir(dir) {};
+    // maps the entry of key into entry; false if there is none for the current source file
+    bool find(const Key& key, Entry& entry) const;
+    // stores planes of height rows of rowBytes each, one plane after the other in data
+    bool store(const Key& key, uint16_t width, uint16_t height, uint32_t rowBytes, uint8_t planes, const uint8_t* data) const;
+    // removes the entry of key, e.g. after its source file was deleted
+    void remove(const Key& key) const;
+  private:
+    struct Header;
+    std::string _name(const Key& key) const;
+    static bool _source(const Key& key, Header& header);
+    std::string _dir;
+};
+
+#endif
@@ -0,0 +1,124 @@
+// Recording transport for GxEPD2_EPD drivers, no panel needed.
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#include "GxEPD2_RecordingTransport.h"
+
+GxEPD2_RecordingTransport::GxEPD2_RecordingTransport(uint32_t capacity) :
+  _events(new Event[capacity > 0 ? capacity : 1]), _capacity(capacity > 0 ? capacity : 1), _read_value(0x00)
+{
+  clear();
+}
+
+GxEPD2_RecordingTransport::~GxEPD2_RecordingTransport()
+{
+  delete[] _events;
+}
+
+void GxEPD2_RecordingTransport::begin(int8_t, int8_t, int8_t, int8_t)
+{
+}
+
+void GxEPD2_RecordingTransport::beginTransaction(const SPISettings&)
+{
+  _transactions++;
+  _record(SELECT, 0);
+}
+
+void GxEPD2_RecordingTransport::endTransaction()
+{
+  _record(DESELECT, 0);
+}
+
+void GxEPD2_RecordingTransport::writeCommand(uint8_t c)
+{
+  _commands++;
+  _record(COMMAND, c);
+}
+
+uint8_t GxEPD2_RecordingTransport::transfer(uint8_t value)
+{
+  _data_bytes++;
+  _record(DATA, value);
+  return _read_value;
+}
+
+void GxEPD2_RecordingTransport::writeData(const uint8_t* data, uint32_t n)
+{
+  _data_bytes += n;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    _record(DATA, data[i]);
+  }
+}
+
+bool GxEPD2_RecordingTransport::waitWhileBusy(uint32_t)
+{
+  _busy_waits++;
+  _record(BUSY, 0);
+  return true;
+}
+
+bool GxEPD2_RecordingTransport::waitWhileAnyBusy(const int8_t*, uint8_t, int8_t, uint32_t)
+{
+  return waitWhileBusy(0);
+}
+
+void GxEPD2_RecordingTransport::clear()
+{
+  _head = 0;
+  _count = 0;
+  _dropped = 0;
+  _commands = 0;
+  _data_bytes = 0;
+  _transactions = 0;
+  _busy_waits = 0;
+}
+
+GxEPD2_RecordingTransport::Event GxEPD2_RecordingTransport::event(uint32_t i) const
+{
+  uint32_t first = (_head + _capacity - _count) % _capacity;
+  return _events[(first + i) % _capacity];
+}
+
+void GxEPD2_RecordingTransport::_record(uint8_t type, uint8_t value)
+{
+  _events[_head].type = type;
+  _events[_head].value = value;
+  _head = (_head + 1) % _capacity;
+  if (_count < _capacity) _count++;
+  else _dropped++;
+}
+
+#ifdef RPI
+void GxEPD2_RecordingTransport::dump(FILE* f) const
+{
+  if (_dropped > 0) fprintf(f, "(%u events dropped)\n", _dropped);
+  bool open_line = false;
+  for (uint32_t i = 0; i < _count; i++)
+  {
+    Event e = event(i);
+    switch (e.type)
+    {
+      case COMMAND:
+        fprintf(f, "%sC %02X", open_line ? "\n" : "", e.value);
+        open_line = true;
+        break;
+      case DATA:
+        fprintf(f, " %02X", e.value);
+        open_line = true;
+        break;
+      case BUSY:
+        fprintf(f, "%sBUSY\n", open_line ? "\n" : "");
+        open_line = false;
+        break;
+    }
+  }
+  if (open_line) fprintf(f, "\n");
+  fprintf(f, "%u commands, %u data bytes, %u transactions, %u busy waits\n", _commands, _data_bytes, _transactions, _busy_waits);
+}
+#endif
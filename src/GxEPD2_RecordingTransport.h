@@ -0,0 +1,83 @@
+// Recording transport for GxEPD2_EPD drivers, no panel needed.
+// Captures the command/data stream in a ring buffer, e.g. for regression tests or to count bytes on the wire.
+//
+// usage: GxEPD2_RecordingTransport recorder; display.epd2.setTransport(&recorder); display.init();
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#ifndef _GxEPD2_RecordingTransport_H_
+#define _GxEPD2_RecordingTransport_H_
+
+#include "GxEPD2_Transport.h"
+
+class GxEPD2_RecordingTransport : public GxEPD2_Transport
+{
+  public:
+    enum EventType
+    {
+      SELECT, DESELECT, COMMAND, DATA, BUSY
+    };
+    struct Event
+    {
+      uint8_t type; // EventType
+      uint8_t value; // command or data byte
+    };
+    // capacity: number of events kept, the oldest events are overwritten when full
+    GxEPD2_RecordingTransport(uint32_t capacity = 65536);
+    ~GxEPD2_RecordingTransport();
+    void begin(int8_t cs, int8_t dc, int8_t busy, int8_t busy_level);
+    void beginTransaction(const SPISettings& settings);
+    void endTransaction();
+    void writeCommand(uint8_t c);
+    uint8_t transfer(uint8_t value);
+    void writeData(const uint8_t* data, uint32_t n);
+    bool waitWhileBusy(uint32_t timeout_us);
+    bool waitWhileAnyBusy(const int8_t* busy, uint8_t n, int8_t busy_level, uint32_t timeout_us);
+    // value returned by transfer(), e.g. 0x00 reads as "ready" from IT8951 status registers
+    void setReadValue(uint8_t value)
+    {
+      _read_value = value;
+    };
+    void clear(); // forget recorded events and counters
+    uint32_t available() const
+    {
+      return _count;
+    };
+    Event event(uint32_t i) const; // i = 0 is the oldest event kept
+    uint32_t dropped() const
+    {
+      return _dropped;
+    };
+    // counters include dropped events
+    uint32_t commands() const
+    {
+      return _commands;
+    };
+    uint32_t dataBytes() const
+    {
+      return _data_bytes;
+    };
+    uint32_t transactions() const
+    {
+      return _transactions;
+    };
+    uint32_t busyWaits() const
+    {
+      return _busy_waits;
+    };
+#ifdef RPI
+    void dump(FILE* f = stdout) const; // one line per command with its data bytes
+#endif
+  private:
+    void _record(uint8_t type, uint8_t value);
+    Event* _events;
+    uint32_t _capacity, _head, _count, _dropped;
+    uint32_t _commands, _data_bytes, _transactions, _busy_waits;
+    uint8_t _read_value;
+};
+
+#endif
@@ -0,0 +1,70 @@
+// Counters and timers of the hot paths of GxEPD2_EPD drivers.
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#include "GxEPD2_Stats.h"
+
+void GxEPD2_Stats::clear()
+{
+  memset(this, 0, sizeof(*this));
+}
+
+const char* GxEPD2_Stats::phaseName(Phase phase)
+{
+  switch (phase)
+  {
+    case CONVERT: return "convert";
+    case TRANSFER: return "transfer";
+    case BUSY: return "busy";
+    case POWER_ON: return "power_on";
+    case POWER_OFF: return "power_off";
+    case RESET: return "reset";
+    default: return "?";
+  }
+}
+
+int GxEPD2_Stats::toJson(char* buf, size_t size) const
+{
+  int len = 0;
+  // appends, keeps counting the length when buf is full
+#define GxEPD2_JSON(...) len += snprintf(buf + (size_t(len) < size ? len : size), size_t(len) < size ? size - len : 0, __VA_ARGS__)
+  GxEPD2_JSON("{\"commands\":%lu,\"data_bytes\":%lu,\"transitions\":%lu,\"full_refreshes\":%lu,\"partial_refreshes\":%lu,\"phases\":{",
+              (unsigned long)commands, (unsigned long)data_bytes, (unsigned long)transitions, (unsigned long)full_refreshes, (unsigned long)partial_refreshes);
+  for (uint8_t i = 0; i < PHASES; i++)
+  {
+    GxEPD2_JSON("%s\"%s\":{\"count\":%lu,\"us\":%lu}", i > 0 ? "," : "", phaseName(Phase(i)),
+                (unsigned long)phase_count[i], (unsigned long)phase_us[i]);
+  }
+  GxEPD2_JSON("},\"bytes_per_command\":{");
+  bool first = true;
+  for (uint16_t c = 0; c < 256; c++)
+  {
+    if (bytes_per_command[c] == 0) continue;
+    GxEPD2_JSON("%s\"0x%02X\":%lu", first ? "" : ",", c, (unsigned long)bytes_per_command[c]);
+    first = false;
+  }
+  GxEPD2_JSON("}}");
+#undef GxEPD2_JSON
+  return len;
+}
+
+#ifdef RPI
+void GxEPD2_Stats::dump(FILE* f) const
+{
+  char buf[4096];
+  int len = toJson(buf, sizeof(buf));
+  if (size_t(len) < sizeof(buf))
+  {
+    fprintf(f, "%s\n", buf);
+    return;
+  }
+  char* big = new char[len + 1];
+  toJson(big, len + 1);
+  fprintf(f, "%s\n", big);
+  delete[] big;
+}
+#endif
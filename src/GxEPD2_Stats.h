@@ -0,0 +1,92 @@
+// Counters and timers of the hot paths of GxEPD2_EPD drivers, e.g. to find where the update time goes.
+// Compiled in with -DGxEPD2_STATS, else the hooks are empty macros and cost nothing.
+//
+// usage: display.epd2.clearStats(); display.display(); display.epd2.stats().dump();
+//
+// Phases may nest, e.g. power on includes its busy wait. The IT8951 drivers count busy waits,
+// power and refreshes, but only part of their SPI traffic.
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#ifndef _GxEPD2_Stats_H_
+#define _GxEPD2_Stats_H_
+
+#include "GxEPD2.h"
+
+class GxEPD2_Stats
+{
+  public:
+    enum Phase
+    {
+      CONVERT, TRANSFER, BUSY, POWER_ON, POWER_OFF, RESET, PHASES
+    };
+    // accumulates the time from construction to destruction to a phase
+    class Timer
+    {
+      public:
+        Timer(GxEPD2_Stats& stats, Phase phase) : _stats(stats), _phase(phase), _start(micros()) {};
+        ~Timer()
+        {
+          _stats.phase_count[_phase]++;
+          _stats.phase_us[_phase] += micros() - _start;
+        };
+      private:
+        GxEPD2_Stats& _stats;
+        Phase _phase;
+        unsigned long _start;
+    };
+    GxEPD2_Stats()
+    {
+      clear();
+    };
+    void clear();
+    void command(uint8_t c)
+    {
+      commands++;
+      if (_in_data) transitions++;
+      _in_data = false;
+      _last_command = c;
+    };
+    void data(uint32_t n)
+    {
+      data_bytes += n;
+      bytes_per_command[_last_command] += n;
+      if (!_in_data) transitions++;
+      _in_data = true;
+    };
+    // JSON object with all counters and phases, zeros too, and the bytes of each command that was sent;
+    // returns the length as snprintf() does
+    int toJson(char* buf, size_t size) const;
+#ifdef RPI
+    void dump(FILE* f = stdout) const;
+#endif
+    static const char* phaseName(Phase phase);
+  public:
+    uint32_t commands, data_bytes;
+    uint32_t transitions; // command to data and data to command
+    uint32_t full_refreshes, partial_refreshes;
+    uint32_t phase_count[PHASES];
+    uint32_t phase_us[PHASES];
+    uint32_t bytes_per_command[256]; // data bytes following each command code
+  private:
+    uint8_t _last_command;
+    bool _in_data;
+};
+
+#ifdef GxEPD2_STATS
+#define GxEPD2_STATS_TIME(phase) GxEPD2_Stats::Timer _stats_timer(_stats, GxEPD2_Stats::phase)
+#define GxEPD2_STATS_COUNT(counter) _stats.counter++
+#define GxEPD2_STATS_COMMAND(c) _stats.command(c)
+#define GxEPD2_STATS_DATA(n) _stats.data(n)
+#else
+#define GxEPD2_STATS_TIME(phase)
+#define GxEPD2_STATS_COUNT(counter)
+#define GxEPD2_STATS_COMMAND(c)
+#define GxEPD2_STATS_DATA(n)
+#endif
+
+#endif
@@ -0,0 +1,118 @@
+// Mirror, rotation, (partial) window and page of GxEPD2_BW, GxEPD2_3C and GxEPD2_7C as one affine map,
+// from x, y in rotated coordinates to the pixel index row * pw_w + column in the page buffer.
+//
+// set() computes the map when rotation, mirror, window or page change; drawPixel() then costs
+// a clip test against the current page in rotated coordinates and two multiply-adds.
+// Panel coordinates, for the dirty region, are affine in x, y too.
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#ifndef _GxEPD2_Transform_H_
+#define _GxEPD2_Transform_H_
+
+#include <stdint.h>
+
+class GxEPD2_Transform
+{
+  public:
+    GxEPD2_Transform() : x0(0), y0(0), x1(0), y1(0), _rotation(0xFF), _page(0) {};
+    // the next valid() is false, after mirror, window or page height changed
+    void invalidate()
+    {
+      _rotation = 0xFF;
+    };
+    // rotation can change by GFX::setRotation(), which is not virtual; the page changes while paging
+    bool valid(uint8_t rotation, uint16_t page) const
+    {
+      return (rotation == _rotation) && (page == _page);
+    };
+    // width, height: of the rotated screen; WIDTH, HEIGHT: of the panel; reverse: page rows bottom up, see GxEPD2_BW
+    void set(uint8_t rotation, bool mirror, int16_t width, int16_t height, int16_t WIDTH, int16_t HEIGHT,
+             uint16_t pw_x, uint16_t pw_y, uint16_t pw_w, uint16_t pw_h, uint16_t page, uint16_t page_height, bool reverse = false)
+    {
+      _rotation = rotation;
+      _page = page;
+      // panel X = _X0 + _Xx * x + _Xy * y, Y likewise, mirror applied first
+      int32_t m0 = mirror ? width - 1 : 0, ms = mirror ? -1 : 1;
+      switch (rotation)
+      {
+        case 1: _setPanel(WIDTH - 1, 0, -1, m0, ms, 0); break;
+        case 2: _setPanel(WIDTH - 1 - m0, -ms, 0, HEIGHT - 1, 0, -1); break;
+        case 3: _setPanel(0, 0, 1, HEIGHT - 1 - m0, -ms, 0); break;
+        default: _setPanel(m0, ms, 0, 0, 0, 1); break;
+      }
+      // page buffer row = r0 + rs * Y
+      int32_t py0 = int32_t(pw_y) + int32_t(page) * page_height;
+      int32_t py1 = py0 + page_height < pw_y + pw_h ? py0 + page_height : pw_y + pw_h;
+      int32_t r0 = reverse ? page_height - 1 + py0 : -py0, rs = reverse ? -1 : 1;
+      _base = (r0 + rs * _Y0) * pw_w + _X0 - pw_x;
+      _dx = rs * _Yx * pw_w + _Xx;
+      _dy = rs * _Yy * pw_w + _Xy;
+      // the page of the window in rotated coordinates, by the inverse map, clipped to the screen
+      x0 = y0 = x1 = y1 = 0;
+      if ((py0 >= py1) || (pw_w == 0)) return;
+      int32_t ax, ay, bx, by;
+      _inverse(pw_x, py0, ax, ay);
+      _inverse(pw_x + pw_w - 1, py1 - 1, bx, by);
+      x0 = _clip(ax < bx ? ax : bx, width);
+      x1 = _clip((ax > bx ? ax : bx) + 1, width);
+      y0 = _clip(ay < by ? ay : by, height);
+      y1 = _clip((ay > by ? ay : by) + 1, height);
+    };
+    bool contains(int16_t x, int16_t y) const
+    {
+      return (x >= x0) && (x < x1) && (y >= y0) && (y < y1);
+    };
+    // x, y must be contained
+    uint32_t index(int16_t x, int16_t y) const
+    {
+      return _base + x * _dx + y * _dy;
+    };
+    uint16_t panelX(int16_t x, int16_t y) const
+    {
+      return _X0 + _Xx * x + _Xy * y;
+    };
+    uint16_t panelY(int16_t x, int16_t y) const
+    {
+      return _Y0 + _Yx * x + _Yy * y;
+    };
+    int16_t x0, y0, x1, y1; // the current page, x1 and y1 exclusive
+  private:
+    void _setPanel(int32_t X0, int32_t Xx, int32_t Xy, int32_t Y0, int32_t Yx, int32_t Yy)
+    {
+      _X0 = X0;
+      _Xx = Xx;
+      _Xy = Xy;
+      _Y0 = Y0;
+      _Yx = Yx;
+      _Yy = Yy;
+    };
+    // the coefficients are 0 or +-1, each is its own inverse
+    void _inverse(int32_t X, int32_t Y, int32_t& x, int32_t& y) const
+    {
+      if (_Xx)
+      {
+        x = (X - _X0) * _Xx;
+        y = (Y - _Y0) * _Yy;
+      }
+      else
+      {
+        x = (Y - _Y0) * _Yx;
+        y = (X - _X0) * _Xy;
+      }
+    };
+    static int16_t _clip(int32_t v, int16_t max)
+    {
+      return v < 0 ? 0 : (v > max ? max : v);
+    };
+    uint8_t _rotation;
+    uint16_t _page;
+    int32_t _base, _dx, _dy;
+    int32_t _X0, _Xx, _Xy, _Y0, _Yx, _Yy;
+};
+
+#endif
@@ -0,0 +1,100 @@
+// Transport interface between GxEPD2_EPD drivers and the e-paper controller.
+// Caution: the e-paper panels require 3.3V supply AND data lines!
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#include "GxEPD2_Transport.h"
+
+bool GxEPD2_Transport::waitWhileAnyBusy(const int8_t* busy, uint8_t n, int8_t busy_level, uint32_t timeout_us)
+{
+#ifdef RPI
+  return RPI_SPI::waitWhileLevel(busy, n, busy_level, timeout_us);
+#else
+  unsigned long start = micros();
+  while (1)
+  {
+    bool any = false;
+    for (uint8_t i = 0; i < n; i++)
+    {
+      if ((busy[i] >= 0) && (digitalRead(busy[i]) == busy_level)) any = true;
+    }
+    if (!any) return true;
+    delay(1);
+    if (micros() - start > timeout_us) return false;
+  }
+#endif
+}
+
+GxEPD2_SPI_Transport::GxEPD2_SPI_Transport() :
+  _cs(-1), _dc(-1), _busy(-1), _busy_level(HIGH)
+{
+}
+
+void GxEPD2_SPI_Transport::begin(int8_t cs, int8_t dc, int8_t busy, int8_t busy_level)
+{
+  _cs = cs;
+  _dc = dc;
+  _busy = busy;
+  _busy_level = busy_level;
+  if (_cs >= 0)
+  {
+    digitalWrite(_cs, HIGH);
+    pinMode(_cs, OUTPUT);
+  }
+  if (_dc >= 0)
+  {
+    digitalWrite(_dc, HIGH);
+    pinMode(_dc, OUTPUT);
+  }
+  if (_busy >= 0)
+  {
+    pinMode(_busy, INPUT);
+  }
+  SPI.begin();
+}
+
+void GxEPD2_SPI_Transport::beginTransaction(const SPISettings& settings)
+{
+  SPI.beginTransaction(settings);
+  if (_cs >= 0) digitalWrite(_cs, LOW);
+}
+
+void GxEPD2_SPI_Transport::endTransaction()
+{
+  if (_cs >= 0) digitalWrite(_cs, HIGH);
+  SPI.endTransaction();
+}
+
+void GxEPD2_SPI_Transport::writeCommand(uint8_t c)
+{
+  if (_dc >= 0) digitalWrite(_dc, LOW);
+  SPI.transfer(c);
+  if (_dc >= 0) digitalWrite(_dc, HIGH);
+}
+
+uint8_t GxEPD2_SPI_Transport::transfer(uint8_t value)
+{
+  return SPI.transfer(value);
+}
+
+void GxEPD2_SPI_Transport::writeData(const uint8_t* data, uint32_t n)
+{
+#ifdef RPI
+  SPI.writeBytes(data, n);
+#else
+  for (uint32_t i = 0; i < n; i++)
+  {
+    SPI.transfer(data[i]);
+  }
+#endif
+}
+
+bool GxEPD2_SPI_Transport::waitWhileBusy(uint32_t timeout_us)
+{
+  if (_busy < 0) return true;
+  return waitWhileAnyBusy(&_busy, 1, _busy_level, timeout_us);
+}
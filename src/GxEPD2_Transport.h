@@ -0,0 +1,55 @@
+// Transport interface between GxEPD2_EPD drivers and the e-paper controller.
+// Caution: the e-paper panels require 3.3V supply AND data lines!
+//
+// GxEPD2_SPI_Transport talks to the panel over SPI (wiringPi/spidev on Raspberry Pi, SPI.h on Arduino).
+// Other transports, e.g. GxEPD2_RecordingTransport, can be selected with GxEPD2_EPD::setTransport().
+//
+// Author: Frank van der Hulst
+//
+// Version: see library.properties
+//
+// Library: https://github.com/ZinggJM/GxEPD2
+
+#ifndef _GxEPD2_Transport_H_
+#define _GxEPD2_Transport_H_
+
+#include "GxEPD2.h"
+
+class GxEPD2_Transport
+{
+  public:
+    virtual ~GxEPD2_Transport() {};
+    // pins as passed to the driver constructor, -1 if not connected
+    virtual void begin(int8_t cs, int8_t dc, int8_t busy, int8_t busy_level) = 0;
+    virtual void end() {};
+    // chip select is asserted from beginTransaction() until endTransaction()
+    virtual void beginTransaction(const SPISettings& settings) = 0;
+    virtual void endTransaction() = 0;
+    // command byte, sent with DC low; following bytes are data
+    virtual void writeCommand(uint8_t c) = 0;
+    // data byte, returns the byte read back (full duplex)
+    virtual uint8_t transfer(uint8_t value) = 0;
+    // data block, nothing is read back
+    virtual void writeData(const uint8_t* data, uint32_t n) = 0;
+    // waits while the busy line is at busy level; returns false on timeout
+    virtual bool waitWhileBusy(uint32_t timeout_us) = 0;
+    // waits while any of n busy lines is at busy_level, e.g. of the four controllers of GxEPD2_1248; -1 pins are ignored
+    virtual bool waitWhileAnyBusy(const int8_t* busy, uint8_t n, int8_t busy_level, uint32_t timeout_us);
+};
+
+class GxEPD2_SPI_Transport : public GxEPD2_Transport
+{
+  public:
+    GxEPD2_SPI_Transport();
+    void begin(int8_t cs, int8_t dc, int8_t busy, int8_t busy_level);
+    void beginTransaction(const SPISettings& settings);
+    void endTransaction();
+    void writeCommand(uint8_t c);
+    uint8_t transfer(uint8_t value);
+    void writeData(const uint8_t* data, uint32_t n);
+    bool waitWhileBusy(uint32_t timeout_us);
+  private:
+    int8_t _cs, _dc, _busy, _busy_level;
+};
+
+#endif
@@ -8,6 +8,14 @@
 // Library: https://github.com/ZinggJM/GxEPD2
 
 #include <unistd.h>
+#include <string.h>
+#ifdef WIN64
+#else
+#include <sys/ioctl.h>
+#include <poll.h>
+#include <linux/spi/spidev.h>
+#include <linux/gpio.h>
+#endif
 
 #include "RPI_SPI.h"
 #include "Debug.h"
@@ -23,6 +31,12 @@ RPI_SPI::RPI_SPI()
 }
 
 RPI_SPI SPI;
+
+// spidev default, replaced by /sys/module/spidev/parameters/bufsiz in begin()
+uint32_t RPI_SPI::_block_size = 4096;
+
+// spidev max speed set in begin(), changed by beginTransaction()
+uint32_t RPI_SPI::_speed = 10000000;
 
 SPISettings::SPISettings(uint32_t speed, uint8_t bitorder, uint8_t mode) :
     _speed(speed), _bitorder(bitorder), _mode(mode)
@@ -82,6 +96,19 @@ static void setPinMode(uint16_t Pin, uint16_t Mode) {
         pinMode(Pin, OUTPUT);
     }
 }
+
+/**
+ * Read the largest message size spidev accepts (module parameter bufsiz)
+**/
+
+static uint32_t readSpidevBufsiz(uint32_t fallback) {
+    FILE *fp = fopen("/sys/module/spidev/parameters/bufsiz", "r");
+    if (fp == NULL) return fallback;
+    unsigned long bufsiz = 0;
+    if (fscanf(fp, "%lu", &bufsiz) != 1 || bufsiz == 0) bufsiz = fallback;
+    fclose(fp);
+    return bufsiz;
+}
 #endif // WIN64
 
 static bool setupDone = false;
@@ -117,8 +144,10 @@ int RPI_SPI::begin(void) {
 
     digitalWrite(_cs, HIGH);
 
-    wiringPiSPISetup(0,10000000);
+    wiringPiSPISetup(0, _speed);
     // wiringPiSPISetupMode(0, 32000000, 0);
+    _block_size = readSpidevBufsiz(_block_size);
+    Debug("spidev block size %u\n", _block_size);
 #endif // WIN64
     Debug("SPI begin complete\n");
     return 0;
@@ -138,8 +167,181 @@ void RPI_SPI::end(void) {
 
 void RPI_SPI::beginTransaction(const SPISettings &_spi_settings) {
     Debug("SPI beginTransaction\n");
+    if (_spi_settings._speed == _speed) return;
+    _speed = _spi_settings._speed;
+#ifdef WIN64
+#else
+    // default for transfers without speed_hz; _transferBlock() also sets it per transfer
+    if (ioctl(wiringPiSPIGetFd(0), SPI_IOC_WR_MAX_SPEED_HZ, &_speed) < 0) {
+        Debug("SPI speed %u Hz failed\n", _speed);
+    }
+#endif // WIN64
+    Debug("SPI speed %u Hz\n", _speed);
 }
 
 void RPI_SPI::endTransaction(void) {
     Debug("SPI endTransaction\n");
 }
+
+/******************************************************************************
+function:	Block transfer, split into chunks no bigger than the spidev buffer
+parameter:	tx: bytes to send
+            rx: buffer for received bytes, may be tx, or NULL if not needed
+Info:       one SPI_IOC_MESSAGE ioctl per chunk instead of one per byte
+******************************************************************************/
+void RPI_SPI::_transferBlock(const uint8_t *tx, uint8_t *rx, uint32_t count) {
+#ifdef WIN64
+    Debug("SPI block write: %u bytes\n", count);
+    if (rx) memset(rx, 0xFF, count);
+#else
+    int fd = wiringPiSPIGetFd(0);
+    while (count > 0) {
+        uint32_t len = count < _block_size ? count : _block_size;
+        struct spi_ioc_transfer xfer;
+        memset(&xfer, 0, sizeof(xfer));
+        xfer.tx_buf = (unsigned long)tx;
+        xfer.rx_buf = (unsigned long)rx;
+        xfer.len = len;
+        xfer.speed_hz = _speed;
+        xfer.bits_per_word = 8;
+        if (ioctl(fd, SPI_IOC_MESSAGE(1), &xfer) < 0) {
+            Debug("SPI block transfer of %u bytes failed\n", len);
+            return;
+        }
+        tx += len;
+        if (rx) rx += len;
+        count -= len;
+    }
+#endif // WIN64
+}
+
+void RPI_SPI::transfer(uint8_t *buf, uint32_t count) {
+    _transferBlock(buf, buf, count);
+}
+
+void RPI_SPI::writeBytes(const uint8_t *data, uint32_t count) {
+    _transferBlock(data, NULL, count);
+}
+
+// GPIO character device of the header pins, empty: looked up by label
+static char gpioChip[64];
+
+void RPI_SPI::setGpioChip(const char *path) {
+    strncpy(gpioChip, path ? path : "", sizeof(gpioChip) - 1);
+}
+
+#ifdef WIN64
+#else
+/**
+ * GPIO character device of the header pins: the RP1 on a Pi 5, the BCM283x/2711 on older models;
+ * /dev/gpiochip0 if no label matches
+**/
+
+static const char *gpioChipPath() {
+    if (gpioChip[0]) return gpioChip;
+    bool bcm = false;
+    for (int i = 0; i < 16; i++) {
+        char path[32];
+        snprintf(path, sizeof(path), "/dev/gpiochip%d", i);
+        int chip = open(path, O_RDONLY);
+        if (chip < 0) continue;
+        struct gpiochip_info info;
+        memset(&info, 0, sizeof(info));
+        bool found = ioctl(chip, GPIO_GET_CHIPINFO_IOCTL, &info) == 0;
+        close(chip);
+        if (!found) continue;
+        if (strcmp(info.label, "pinctrl-rp1") == 0) {
+            strcpy(gpioChip, path);
+            break;
+        }
+        if (!bcm && (strncmp(info.label, "pinctrl-bcm", 11) == 0)) {
+            strcpy(gpioChip, path); // unless an RP1 follows
+            bcm = true;
+        }
+    }
+    if (!gpioChip[0]) strcpy(gpioChip, "/dev/gpiochip0");
+    Debug("GPIO chip %s\n", gpioChip);
+    return gpioChip;
+}
+
+/**
+ * Line event fd for a BCM pin, requested once and kept open; -1 if unavailable
+**/
+
+static int lineEventFd(int8_t pin) {
+    static int fds[64]; // 0: not requested yet, fd + 1 if requested, -1 if unavailable
+    if (pin < 0 || pin >= 64) return -1;
+    if (fds[pin] == 0) {
+        fds[pin] = -1;
+        int chip = open(gpioChipPath(), O_RDONLY);
+        if (chip >= 0) {
+            struct gpioevent_request req;
+            memset(&req, 0, sizeof(req));
+            req.lineoffset = pin;
+            req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+            req.eventflags = GPIOEVENT_REQUEST_BOTH_EDGES;
+            strncpy(req.consumer_label, "GxEPD2 busy", sizeof(req.consumer_label) - 1);
+            if (ioctl(chip, GPIO_GET_LINEEVENT_IOCTL, &req) == 0) {
+                fcntl(req.fd, F_SETFL, fcntl(req.fd, F_GETFL) | O_NONBLOCK);
+                fds[pin] = req.fd + 1;
+            }
+            close(chip);
+        }
+        if (fds[pin] < 0) {
+            Debug("No line events for GPIO %d, polling\n", pin);
+        }
+    }
+    return fds[pin] > 0 ? fds[pin] - 1 : -1;
+}
+#endif // WIN64
+
+/******************************************************************************
+function:	Wait while any of the pins is at level, e.g. BUSY pins of one or more controllers
+parameter:	pins, n: pins to watch, negative pins are ignored
+            level: busy level
+            timeout_us: maximum wait
+Info:       blocks in poll() until an edge arrives instead of waking up every 1ms
+******************************************************************************/
+bool RPI_SPI::waitWhileLevel(const int8_t *pins, uint8_t n, int level, uint32_t timeout_us) {
+    unsigned long start = micros();
+#ifdef WIN64
+#else
+    struct pollfd pfd[8];
+    uint8_t nfd = 0;
+    bool events = n <= 8;
+    for (uint8_t i = 0; events && (i < n); i++) {
+        if (pins[i] < 0) continue;
+        int fd = lineEventFd(pins[i]);
+        if (fd < 0) events = false;
+        pfd[nfd].fd = fd;
+        pfd[nfd].events = POLLIN | POLLPRI;
+        pfd[nfd].revents = 0;
+        nfd++;
+    }
+#endif // WIN64
+    while (1) {
+#ifdef WIN64
+#else
+        // drain pending edges before sampling, an edge after sampling wakes up poll()
+        if (events) {
+            struct gpioevent_data event;
+            for (uint8_t i = 0; i < nfd; i++) {
+                while (read(pfd[i].fd, &event, sizeof(event)) == sizeof(event));
+            }
+        }
+#endif // WIN64
+        bool busy = false;
+        for (uint8_t i = 0; i < n; i++) {
+            if ((pins[i] >= 0) && (digitalRead(pins[i]) == level)) busy = true;
+        }
+        if (!busy) return true;
+        unsigned long elapsed = micros() - start;
+        if (elapsed > timeout_us) return false;
+#ifdef WIN64
+        delay(1);
+#else
+        if (events) poll(pfd, nfd, (timeout_us - elapsed) / 1000 + 1);
+        else delay(1);
+#endif // WIN64
+    }
+}
@@ -12,6 +12,7 @@
 
 #include <iostream>
 #include <stdio.h>
+#include <string.h>
 #include <fcntl.h>
 
 #include "Debug.h"
@@ -37,6 +38,7 @@ class SPISettings {
 public:
     SPISettings(uint32_t speed, uint8_t bitorder, uint8_t mode);
 private:
+    friend class RPI_SPI;
     uint32_t _speed;
     uint8_t _bitorder;
     uint8_t _mode;
@@ -52,19 +54,35 @@ class RPI_SPI
     void _writeCommandData(const uint8_t* pCommandData, uint8_t datalen);
     void _beginTransfer();
     static inline uint8_t transfer(uint8_t *value) {
-        wiringPiSPIDataRW(0, value, 1);
+        _transferBlock(value, value, 1);
         return *value;
     };
     static inline uint8_t transfer(uint8_t value) {
-        wiringPiSPIDataRW(0, &value, 1);
+        _transferBlock(&value, &value, 1);
         return value;
     };
+    // block transfers, one SPI_IOC_MESSAGE per chunk of at most blockSize() bytes
+    void transfer(uint8_t *buf, uint32_t count); // full duplex, received bytes replace buf
+    void writeBytes(const uint8_t *data, uint32_t count); // write only, nothing is read back
+    static inline uint32_t blockSize() {
+        return _block_size;
+    };
     void _endTransfer();
     int begin(void);
     void end(void);
 
     void beginTransaction(const SPISettings &_spi_settings);
     void endTransaction(void);
+    // waits until none of the n pins is at level, sleeping on GPIO line events of the header's GPIO chip,
+    // falls back to polling every 1ms if line events are unavailable; returns false on timeout
+    static bool waitWhileLevel(const int8_t *pins, uint8_t n, int level, uint32_t timeout_us);
+    // GPIO character device for line events, e.g. "/dev/gpiochip4"; default: the chip labelled pinctrl-rp1 (Pi 5)
+    // or pinctrl-bcm* (older models); call before the first busy wait
+    static void setGpioChip(const char *path);
+private:
+    static void _transferBlock(const uint8_t *tx, uint8_t *rx, uint32_t count);
+    static uint32_t _block_size; // spidev bufsiz, largest transfer the kernel accepts in one message
+    static uint32_t _speed; // SPI clock of the current transaction, Hz
 };
 extern RPI_SPI SPI;
 #endif // RPI_SPI_H
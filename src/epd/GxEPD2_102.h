@@ -32,6 +32,7 @@ class GxEPD2_102 : public GxEPD2_EPD
     static const uint16_t power_off_time = 250; // ms, e.g. 202366us
     static const uint16_t full_refresh_time = 3600; // ms, e.g. 3507492us
     static const uint16_t partial_refresh_time = 1200; // ms, e.g. 1102149us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of UC8175
     // constructor
     GxEPD2_102(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
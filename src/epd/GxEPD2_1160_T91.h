@@ -30,6 +30,7 @@ class GxEPD2_1160_T91 : public GxEPD2_EPD
     static const uint16_t power_off_time = 150; // ms, e.g. 140001us
     static const uint16_t full_refresh_time = 6200; // ms, e.g. 6180001us
     static const uint16_t partial_refresh_time = 6200; // ms, e.g. 6180001us
+    static const uint32_t spi_clock = 20000000; // Hz, max. write clock of SSD1677
     // constructor
     GxEPD2_1160_T91(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
@@ -19,7 +19,7 @@ GxEPD2_1248::GxEPD2_1248(int8_t sck, int8_t miso, int8_t mosi,
                          int8_t cs_m1, int8_t cs_s1, int8_t cs_m2, int8_t cs_s2,
                          int8_t dc1, int8_t dc2, int8_t rst1, int8_t rst2,
                          int8_t busy_m1, int8_t busy_s1, int8_t busy_m2, int8_t busy_s2) :
-  GxEPD2_EPD(cs_m1, dc1, rst1, busy_m1, LOW, 10000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate),
+  GxEPD2_EPD(cs_m1, dc1, rst1, busy_m1, LOW, 10000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate, spi_clock),
   _sck(sck), _miso(miso), _mosi(mosi), _dc1(dc1), _dc2(dc2), _rst1(rst1), _rst2(rst2),
   _cs_m1(cs_m1), _cs_s1(cs_s1), _cs_m2(cs_m2), _cs_s2(cs_s2),
   _busy_m1(busy_m1), _busy_s1(busy_s1), _busy_m2(busy_m2), _busy_s2(busy_s2),
@@ -36,7 +36,7 @@ GxEPD2_1248::GxEPD2_1248(int8_t sck, int8_t miso, int8_t mosi,
 GxEPD2_1248::GxEPD2_1248(int8_t cs_m1, int8_t cs_s1, int8_t cs_m2, int8_t cs_s2,
                          int8_t dc1, int8_t dc2, int8_t rst1, int8_t rst2,
                          int8_t busy_m1, int8_t busy_s1, int8_t busy_m2, int8_t busy_s2) :
-  GxEPD2_EPD(cs_m1, dc1, rst1, busy_m1, LOW, 10000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate),
+  GxEPD2_EPD(cs_m1, dc1, rst1, busy_m1, LOW, 10000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate, spi_clock),
 #ifdef RPI
 #else
   _sck(SCK), _miso(MISO), _mosi(MOSI),
@@ -54,7 +54,7 @@ GxEPD2_1248::GxEPD2_1248(int8_t cs_m1, int8_t cs_s1, int8_t cs_m2, int8_t cs_s2,
 
 // constructor with minimal parameter set, standard SPI, dc1 and dc2, rst1 and rst2 to one pin, one busy used (can be -1)
 GxEPD2_1248::GxEPD2_1248(int8_t cs_m1, int8_t cs_s1, int8_t cs_m2, int8_t cs_s2, int8_t dc, int8_t rst, int8_t busy) :
-  GxEPD2_EPD(23, 25, 33, 32, LOW, 10000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate),
+  GxEPD2_EPD(23, 25, 33, 32, LOW, 10000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate, spi_clock),
 #ifdef RPI
 #else
   _sck(SCK), _miso(MISO), _mosi(MOSI),
@@ -105,6 +105,10 @@ void GxEPD2_1248::init(uint32_t serial_diag_bitrate, bool initial, uint16_t rese
   digitalWrite(_cs_s1,  HIGH);
   digitalWrite(_cs_m2,  HIGH);
   digitalWrite(_cs_s2,  HIGH);
+  M1.begin(this);
+  S1.begin(this);
+  M2.begin(this);
+  S2.begin(this);
   _initSPI();
   _reset();
   // only relevant for full refresh, comment out if 20 is ok
@@ -123,35 +127,26 @@ void GxEPD2_1248::writeScreenBuffer(uint8_t value)
   if (!_using_partial_mode) _Init_Part();
   if (_initial_write)
   {
-    M1.writeScreenBuffer(0x10, value);
-    S1.writeScreenBuffer(0x10, value);
-    M2.writeScreenBuffer(0x10, value);
-    S2.writeScreenBuffer(0x10, value);
+    M1.writeScreenBuffer(0x10, value, &S2);
+    S1.writeScreenBuffer(0x10, value, &M2);
   }
-  M1.writeScreenBuffer(0x13, value);
-  S1.writeScreenBuffer(0x13, value);
-  M2.writeScreenBuffer(0x13, value);
-  S2.writeScreenBuffer(0x13, value);
+  M1.writeScreenBuffer(0x13, value, &S2);
+  S1.writeScreenBuffer(0x13, value, &M2);
   _initial_write = false; // initial full screen buffer clean done
 }
 
 void GxEPD2_1248::writeScreenBufferAgain(uint8_t value)
 {
   if (!_using_partial_mode) _Init_Part();
-  M1.writeScreenBuffer(0x10, value);
-  S1.writeScreenBuffer(0x10, value);
-  M2.writeScreenBuffer(0x10, value);
-  S2.writeScreenBuffer(0x10, value);
+  M1.writeScreenBuffer(0x10, value, &S2);
+  S1.writeScreenBuffer(0x10, value, &M2);
 }
 
 void GxEPD2_1248::writeImage(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
 {
   if (_initial_write) writeScreenBuffer(); // initial full screen buffer clean
   if (!_using_partial_mode) _Init_Part();
-  S2.writeImagePart(0x13, bitmap, 0, 0, w, h, x, y, w, h, invert, mirror_y, pgm);
-  M2.writeImagePart(0x13, bitmap, 0, 0, w, h, x - S2.WIDTH, y, w, h, invert, mirror_y, pgm);
-  M1.writeImagePart(0x13, bitmap, 0, 0, w, h, x, y - S2.HEIGHT, w, h, invert, mirror_y, pgm);
-  S1.writeImagePart(0x13, bitmap, 0, 0, w, h, x - M1.WIDTH, y - M2.HEIGHT, w, h, invert, mirror_y, pgm);
+  _writeImageParts(0x13, bitmap, 0, 0, w, h, x, y, w, h, invert, mirror_y, pgm);
 }
 
 void GxEPD2_1248::writeImagePart(const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
@@ -159,20 +154,14 @@ void GxEPD2_1248::writeImagePart(const uint8_t bitmap[], int16_t x_part, int16_t
 {
   if (_initial_write) writeScreenBuffer(); // initial full screen buffer clean
   if (!_using_partial_mode) _Init_Part();
-  S2.writeImagePart(0x13, bitmap, x_part, y_part, w, h, x, y, w, h, invert, mirror_y, pgm);
-  M2.writeImagePart(0x13, bitmap, x_part, y_part, w, h, x - S2.WIDTH, y, w, h, invert, mirror_y, pgm);
-  M1.writeImagePart(0x13, bitmap, x_part, y_part, w, h, x, y - S2.HEIGHT, w, h, invert, mirror_y, pgm);
-  S1.writeImagePart(0x13, bitmap, x_part, y_part, w, h, x - M1.WIDTH, y - M2.HEIGHT, w, h, invert, mirror_y, pgm);
+  _writeImageParts(0x13, bitmap, x_part, y_part, w, h, x, y, w, h, invert, mirror_y, pgm);
 }
 
 void GxEPD2_1248::writeImageAgain(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
 {
   if (_initial_write) writeScreenBuffer(); // initial full screen buffer clean
   if (!_using_partial_mode) _Init_Part();
-  S2.writeImagePart(0x10, bitmap, 0, 0, w, h, x, y, w, h, invert, mirror_y, pgm);
-  M2.writeImagePart(0x10, bitmap, 0, 0, w, h, x - S2.WIDTH, y, w, h, invert, mirror_y, pgm);
-  M1.writeImagePart(0x10, bitmap, 0, 0, w, h, x, y - S2.HEIGHT, w, h, invert, mirror_y, pgm);
-  S1.writeImagePart(0x10, bitmap, 0, 0, w, h, x - M1.WIDTH, y - M2.HEIGHT, w, h, invert, mirror_y, pgm);
+  _writeImageParts(0x10, bitmap, 0, 0, w, h, x, y, w, h, invert, mirror_y, pgm);
 }
 
 void GxEPD2_1248::writeImagePartAgain(const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
@@ -180,10 +169,7 @@ void GxEPD2_1248::writeImagePartAgain(const uint8_t bitmap[], int16_t x_part, in
 {
   if (_initial_write) writeScreenBuffer(); // initial full screen buffer clean
   if (!_using_partial_mode) _Init_Part();
-  S2.writeImagePart(0x10, bitmap, x_part, y_part, w, h, x, y, w, h, invert, mirror_y, pgm);
-  M2.writeImagePart(0x10, bitmap, x_part, y_part, w, h, x - S2.WIDTH, y, w, h, invert, mirror_y, pgm);
-  M1.writeImagePart(0x10, bitmap, x_part, y_part, w, h, x, y - S2.HEIGHT, w, h, invert, mirror_y, pgm);
-  S1.writeImagePart(0x10, bitmap, x_part, y_part, w, h, x - M1.WIDTH, y - M2.HEIGHT, w, h, invert, mirror_y, pgm);
+  _writeImageParts(0x10, bitmap, x_part, y_part, w, h, x, y, w, h, invert, mirror_y, pgm);
 }
 
 void GxEPD2_1248::writeImage(const uint8_t* black, const uint8_t* color, int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
@@ -287,6 +273,7 @@ void GxEPD2_1248::hibernate()
 
 void GxEPD2_1248::_reset(void)
 {
+  GxEPD2_STATS_TIME(RESET);
   digitalWrite(_rst1, LOW);
   digitalWrite(_rst2, LOW);
   delay(200);
@@ -298,15 +285,13 @@ void GxEPD2_1248::_reset(void)
 
 void GxEPD2_1248::_initSPI()
 {
+  _transport->begin(-1, -1, -1, _busy_level); // chip selects, dc and busy of the four controllers are driven here
 #if defined(ESP32)
   if ((SCK != _sck) || (MISO != _miso) || (MOSI != _mosi))
   {
     SPI.end();
     SPI.begin(_sck, _miso, _mosi, _cs_m1);
   }
-  else SPI.begin();
-#else
-  SPI.begin();
 #endif
 }
 
@@ -329,6 +314,7 @@ void GxEPD2_1248::_setPartialRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_
 
 void GxEPD2_1248::_PowerOn()
 {
+  GxEPD2_STATS_TIME(POWER_ON);
   if (!_power_is_on)
   {
     _writeCommandMaster(0x04);
@@ -339,6 +325,7 @@ void GxEPD2_1248::_PowerOn()
 
 void GxEPD2_1248::_PowerOff()
 {
+  GxEPD2_STATS_TIME(POWER_OFF);
   if (_power_is_on)
   {
     _writeCommandMaster(0x02); // power off
@@ -513,119 +500,113 @@ void GxEPD2_1248::_Init_Part()
 
 void GxEPD2_1248::_Update_Full()
 {
+  GxEPD2_STATS_COUNT(full_refreshes);
   _writeCommandAll(0x12); //display refresh
   _waitWhileAnyBusy("_Update_Full", full_refresh_time);
 }
 
 void GxEPD2_1248::_Update_Part()
 {
+  GxEPD2_STATS_COUNT(partial_refreshes);
   _writeCommandAll(0x12); //display refresh
   _waitWhileAnyBusy("_Update_Part", partial_refresh_time);
 }
 
 void GxEPD2_1248::_writeCommandMaster(uint8_t c)
 {
-  SPI.beginTransaction(_spi_settings);
+  _startTransfer();
   digitalWrite(_dc1, LOW);
   digitalWrite(_dc2, LOW);
   digitalWrite(_cs_m1, LOW);
   digitalWrite(_cs_m2, LOW);
-  SPI.transfer(c);
+  _command(c);
   digitalWrite(_cs_m1, HIGH);
   digitalWrite(_cs_m2, HIGH);
   digitalWrite(_dc1, HIGH);
   digitalWrite(_dc2, HIGH);
-  SPI.endTransaction();
+  _transport->endTransaction();
 }
 
 void GxEPD2_1248::_writeDataMaster(uint8_t d)
 {
-  SPI.beginTransaction(_spi_settings);
+  _startTransfer();
   digitalWrite(_cs_m1, LOW);
   digitalWrite(_cs_m2, LOW);
-  SPI.transfer(d);
+  _transfer(d);
+  _flushTransfer();
   digitalWrite(_cs_m1, HIGH);
   digitalWrite(_cs_m2, HIGH);
-  SPI.endTransaction();
+  _transport->endTransaction();
 }
 
 void GxEPD2_1248::_writeCommandAll(uint8_t c)
 {
-  SPI.beginTransaction(_spi_settings);
+  _startTransfer();
   digitalWrite(_dc1, LOW);
   digitalWrite(_dc2, LOW);
   digitalWrite(_cs_m1, LOW);
   digitalWrite(_cs_s1, LOW);
   digitalWrite(_cs_m2, LOW);
   digitalWrite(_cs_s2, LOW);
-  SPI.transfer(c);
+  _command(c);
   digitalWrite(_cs_m1, HIGH);
   digitalWrite(_cs_s1, HIGH);
   digitalWrite(_cs_m2, HIGH);
   digitalWrite(_cs_s2, HIGH);
   digitalWrite(_dc1, HIGH);
   digitalWrite(_dc2, HIGH);
-  SPI.endTransaction();
+  _transport->endTransaction();
 }
 
 void GxEPD2_1248::_writeDataAll(uint8_t d)
 {
-  SPI.beginTransaction(_spi_settings);
+  _startTransfer();
   digitalWrite(_cs_m1, LOW);
   digitalWrite(_cs_s1, LOW);
   digitalWrite(_cs_m2, LOW);
   digitalWrite(_cs_s2, LOW);
-  SPI.transfer(d);
+  _transfer(d);
+  _flushTransfer();
   digitalWrite(_cs_m1, HIGH);
   digitalWrite(_cs_s1, HIGH);
   digitalWrite(_cs_m2, HIGH);
   digitalWrite(_cs_s2, HIGH);
-  SPI.endTransaction();
+  _transport->endTransaction();
 }
 
 void GxEPD2_1248::_writeDataPGM_All(const uint8_t* data, uint16_t n, int16_t fill_with_zeroes)
 {
-  SPI.beginTransaction(_spi_settings);
+  _startTransfer();
   digitalWrite(_cs_m1, LOW);
   digitalWrite(_cs_s1, LOW);
   digitalWrite(_cs_m2, LOW);
   digitalWrite(_cs_s2, LOW);
-  for (uint16_t i = 0; i < n; i++)
-  {
-    SPI.transfer(pgm_read_byte(&*data++));
-  }
-  while (fill_with_zeroes > 0)
-  {
-    SPI.transfer((uint8_t)0x00);
-    fill_with_zeroes--;
-  }
+  _transfer(data, n, false, true);
+  if (fill_with_zeroes > 0) _transferFill(0x00, fill_with_zeroes);
   digitalWrite(_cs_m1, HIGH);
   digitalWrite(_cs_s1, HIGH);
   digitalWrite(_cs_m2, HIGH);
   digitalWrite(_cs_s2, HIGH);
-  SPI.endTransaction();
+  _transport->endTransaction();
+}
+
+void GxEPD2_1248::_command(uint8_t c)
+{
+  GxEPD2_STATS_COMMAND(c);
+  _transport->writeCommand(c);
 }
 
 void GxEPD2_1248::_waitWhileAnyBusy(const char* comment, uint16_t busy_time)
 {
+  GxEPD2_STATS_TIME(BUSY);
   if (_busy_m1 >= 0)
   {
     delay(1); // add some margin to become active
     unsigned long start = micros();
-    while (1)
+    const int8_t busy_pins[] = {_busy_m1, _busy_s1, _busy_m2, _busy_s2};
+    if (!_transport->waitWhileAnyBusy(busy_pins, 4, _busy_level, _busy_timeout))
     {
-      delay(1); // add some margin to become active
-      bool nb_m1 = _busy_m1 >= 0 ? _busy_level != digitalRead(_busy_m1) : true;
-      bool nb_s1 = _busy_m1 >= 0 ? _busy_level != digitalRead(_busy_s1) : true;
-      bool nb_m2 = _busy_m1 >= 0 ? _busy_level != digitalRead(_busy_m2) : true;
-      bool nb_s2 = _busy_m1 >= 0 ? _busy_level != digitalRead(_busy_s2) : true;
-      if (nb_m1 && nb_s1 && nb_m2 && nb_s2) break;
-      delay(1);
-      if (micros() - start > _busy_timeout)
-      {
-        Debug("Busy Timeout!\n");
-        break;
-      }
+      Debug("Busy Timeout!\n");
     }
     if (comment)
     {
@@ -639,6 +620,44 @@ void GxEPD2_1248::_waitWhileAnyBusy(const char* comment, uint16_t busy_time)
   else delay(busy_time);
 }
 
+void GxEPD2_1248::_writeImageParts(uint8_t command, const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
+                                   int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
+{
+#ifdef RPI
+  // M1 and S2 are the same size, so are S1 and M2; one pair is prepared while the other is on the bus
+  ScreenPart::Upload s2, m1, m2, s1;
+  S2.prepareImagePart(s2, bitmap, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h, invert, mirror_y);
+  M1.prepareImagePart(m1, bitmap, x_part, y_part, w_bitmap, h_bitmap, x, y - S2.HEIGHT, w, h, invert, mirror_y);
+  std::future<void> next = std::async(std::launch::async, [&]()
+  {
+    M2.prepareImagePart(m2, bitmap, x_part, y_part, w_bitmap, h_bitmap, x - S2.WIDTH, y, w, h, invert, mirror_y);
+    S1.prepareImagePart(s1, bitmap, x_part, y_part, w_bitmap, h_bitmap, x - M1.WIDTH, y - M2.HEIGHT, w, h, invert, mirror_y);
+  });
+  const ScreenPart::Upload* pairs[2][2] = {{&s2, &m1}, {&m2, &s1}};
+  ScreenPart* parts[2][2] = {{&S2, &M1}, {&M2, &S1}};
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    if (i == 1) next.wait();
+    const ScreenPart::Upload& a = *pairs[i][0];
+    const ScreenPart::Upload& b = *pairs[i][1];
+    if ((a.w > 0) && (a.ram_x == b.ram_x) && (a.y == b.y) && (a.w == b.w) && (a.h == b.h) && (a.data == b.data))
+    {
+      parts[i][0]->writeUpload(command, a, parts[i][1]); // broadcast
+    }
+    else
+    {
+      parts[i][0]->writeUpload(command, a);
+      parts[i][1]->writeUpload(command, b);
+    }
+  }
+#else
+  S2.writeImagePart(command, bitmap, x_part, y_part, w_bitmap, h_bitmap, x, y, w, h, invert, mirror_y, pgm);
+  M2.writeImagePart(command, bitmap, x_part, y_part, w_bitmap, h_bitmap, x - S2.WIDTH, y, w, h, invert, mirror_y, pgm);
+  M1.writeImagePart(command, bitmap, x_part, y_part, w_bitmap, h_bitmap, x, y - S2.HEIGHT, w, h, invert, mirror_y, pgm);
+  S1.writeImagePart(command, bitmap, x_part, y_part, w_bitmap, h_bitmap, x - M1.WIDTH, y - M2.HEIGHT, w, h, invert, mirror_y, pgm);
+#endif
+}
+
 void GxEPD2_1248::_getMasterTemperature()
 {
   uint8_t value = 0;
@@ -675,13 +694,13 @@ void GxEPD2_1248::_readController(uint8_t cmd, uint8_t* data, uint16_t n, int8_t
 {
   if (cs < 0) cs = _cs_m1;
   if (dc < 0) dc = _dc1;
-  SPI.beginTransaction(_spi_settings);
+  _startTransfer();
   digitalWrite(cs, LOW);
   digitalWrite(dc, LOW);
-  SPI.transfer(cmd);
+  _command(cmd);
   digitalWrite(dc, HIGH);
   digitalWrite(cs, HIGH);
-  SPI.endTransaction();
+  _transport->endTransaction();
   _waitWhileAnyBusy("_readController", 300);
   SPI.end();
   pinMode(_mosi, INPUT);
@@ -690,6 +709,7 @@ void GxEPD2_1248::_readController(uint8_t cmd, uint8_t* data, uint16_t n, int8_t
   pinMode(_sck, OUTPUT);
   digitalWrite(cs, LOW);
   pinMode(_mosi, INPUT);
+  const uint16_t half_period = 500000 / spi_read_clock; // us
   for (uint16_t j = 0; j < n; j++)
   {
     uint8_t value = 0;
@@ -697,11 +717,10 @@ void GxEPD2_1248::_readController(uint8_t cmd, uint8_t* data, uint16_t n, int8_t
     {
       digitalWrite(_sck, LOW);
       value <<= 1;
-      delayMicroseconds(2);
+      delayMicroseconds(half_period);
       if (digitalRead(_mosi)) value |= 0x01;
-      delayMicroseconds(2);
       digitalWrite(_sck, HIGH);
-      delayMicroseconds(2);
+      delayMicroseconds(half_period);
     }
     data[j] = value;
   }
@@ -712,17 +731,23 @@ void GxEPD2_1248::_readController(uint8_t cmd, uint8_t* data, uint16_t n, int8_t
 
 GxEPD2_1248::ScreenPart::ScreenPart(uint16_t width, uint16_t height, bool rev_scan, int8_t cs, int8_t dc) :
   WIDTH(width), HEIGHT(height), _rev_scan(rev_scan),
-  _cs(cs), _dc(dc), _spi_settings(4000000, MSBFIRST, SPI_MODE0)
+  _cs(cs), _dc(dc), _epd(0), _peer(0)
 {
 }
 
-void GxEPD2_1248::ScreenPart::writeScreenBuffer(uint8_t command, uint8_t value)
+void GxEPD2_1248::ScreenPart::begin(GxEPD2_1248* epd)
 {
+  _epd = epd;
+}
+
+void GxEPD2_1248::ScreenPart::writeScreenBuffer(uint8_t command, uint8_t value, ScreenPart* peer)
+{
+  _peer = peer;
   writeCommand(command); // set current or previous
-  for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(HEIGHT) / 8; i++)
-  {
-    writeData(value);
-  }
+  _startTransfer();
+  _epd->_transferFill(value, uint32_t(WIDTH) * uint32_t(HEIGHT) / 8);
+  _endTransfer();
+  _peer = 0;
 }
 
 void GxEPD2_1248::ScreenPart::writeImagePart(uint8_t command, const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
@@ -756,50 +781,92 @@ void GxEPD2_1248::ScreenPart::writeImagePart(uint8_t command, const uint8_t bitm
   _startTransfer();
   for (int16_t i = 0; i < h1; i++)
   {
-    for (int16_t j = 0; j < w1 / 8; j++)
+    // use wb_bitmap, h_bitmap of bitmap for index!
+    int32_t idx = mirror_y ? x_part / 8 + dx / 8 + ((h_bitmap - 1 - (y_part + i + dy))) * wb_bitmap : x_part / 8 + dx / 8 + (y_part + i + dy) * wb_bitmap;
+    _epd->_transfer(&bitmap[idx], w1 / 8, invert, pgm);
+  }
+  _endTransfer();
+  writeCommand(0x92); // partial out
+  delay(1); // yield() to avoid WDT on ESP8266 and ESP32
+}
+
+#ifdef RPI
+void GxEPD2_1248::ScreenPart::prepareImagePart(Upload& upload, const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
+    int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y)
+{
+  upload.w = 0;
+  if ((w_bitmap < 0) || (h_bitmap < 0) || (w < 0) || (h < 0)) return;
+  if ((x_part < 0) || (x_part >= w_bitmap)) return;
+  if ((y_part < 0) || (y_part >= h_bitmap)) return;
+  int32_t wb_bitmap = (w_bitmap + 7) / 8; // width bytes, bitmaps are padded
+  x_part -= x_part % 8; // byte boundary
+  w = w_bitmap - x_part < w ? w_bitmap - x_part : w; // limit
+  h = h_bitmap - y_part < h ? h_bitmap - y_part : h; // limit
+  x -= x % 8; // byte boundary
+  w = 8 * ((w + 7) / 8); // byte boundary, bitmaps are padded
+  int16_t x1 = x < 0 ? 0 : x; // limit
+  int16_t y1 = y < 0 ? 0 : y; // limit
+  int16_t w1 = x + w < int16_t(WIDTH) ? w : int16_t(WIDTH) - x; // limit
+  int16_t h1 = y + h < int16_t(HEIGHT) ? h : int16_t(HEIGHT) - y; // limit
+  int16_t dx = x1 - x;
+  int16_t dy = y1 - y;
+  w1 -= dx;
+  h1 -= dy;
+  if ((w1 <= 0) || (h1 <= 0)) return;
+  upload.x = x1;
+  upload.y = y1;
+  upload.w = w1;
+  upload.h = h1;
+  upload.ram_x = _rev_scan ? int16_t(WIDTH) - w1 - x1 : x1;
+  uint16_t wb = w1 / 8;
+  upload.data.resize(uint32_t(h1) * wb);
+  uint8_t* out = upload.data.data();
+  for (int16_t i = 0; i < h1; i++)
+  {
+    // use wb_bitmap, h_bitmap of bitmap for index!
+    int32_t idx = mirror_y ? x_part / 8 + dx / 8 + ((h_bitmap - 1 - (y_part + i + dy))) * wb_bitmap : x_part / 8 + dx / 8 + (y_part + i + dy) * wb_bitmap;
+    if (invert)
     {
-      uint8_t data;
-      // use wb_bitmap, h_bitmap of bitmap for index!
-      int32_t idx = mirror_y ? x_part / 8 + j + dx / 8 + ((h_bitmap - 1 - (y_part + i + dy))) * wb_bitmap : x_part / 8 + j + dx / 8 + (y_part + i + dy) * wb_bitmap;
-      if (pgm)
-      {
-#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
-        data = pgm_read_byte(&bitmap[idx]);
-#else
-        data = bitmap[idx];
-#endif
-      }
-      else
-      {
-        data = bitmap[idx];
-      }
-      if (invert) data = ~data;
-      _transfer(data);
+      for (uint16_t j = 0; j < wb; j++) out[j] = ~bitmap[idx + j];
     }
+    else memcpy(out, &bitmap[idx], wb);
+    out += wb;
   }
+}
+
+void GxEPD2_1248::ScreenPart::writeUpload(uint8_t command, const Upload& upload, ScreenPart* peer)
+{
+  if (upload.w <= 0) return;
+  _peer = peer;
+  writeCommand(0x91); // partial in
+  _setPartialRamArea(upload.x, upload.y, upload.w, upload.h);
+  writeCommand(command);
+  _startTransfer();
+  _epd->_transfer(upload.data.data(), uint16_t(upload.data.size()));
   _endTransfer();
   writeCommand(0x92); // partial out
-  delay(1); // yield() to avoid WDT on ESP8266 and ESP32
+  _peer = 0;
 }
+#endif
 
 void GxEPD2_1248::ScreenPart::writeCommand(uint8_t c)
 {
-  SPI.beginTransaction(_spi_settings);
+  _epd->_startTransfer();
   if (_dc >= 0) digitalWrite(_dc, LOW);
   if (_cs >= 0) digitalWrite(_cs, LOW);
-  SPI.transfer(c);
+  if (_peer) _peer->_select(LOW, LOW);
+  _epd->_command(c);
+  if (_peer) _peer->_select(HIGH, HIGH);
   if (_cs >= 0) digitalWrite(_cs, HIGH);
   if (_dc >= 0) digitalWrite(_dc, HIGH);
-  SPI.endTransaction();
+  _epd->_transport->endTransaction();
 }
 
 void GxEPD2_1248::ScreenPart::writeData(uint8_t d)
 {
-  SPI.beginTransaction(_spi_settings);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
-  SPI.transfer(d);
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _startTransfer();
+  _epd->_transfer(d);
+  _endTransfer();
 }
 
 void GxEPD2_1248::ScreenPart::_setPartialRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
@@ -822,17 +889,29 @@ void GxEPD2_1248::ScreenPart::_setPartialRamArea(uint16_t x, uint16_t y, uint16_
 
 void GxEPD2_1248::ScreenPart::_startTransfer()
 {
-  SPI.beginTransaction(_spi_settings);
+  _epd->_startTransfer();
   if (_cs >= 0) digitalWrite(_cs, LOW);
+  if (_peer) _peer->_select(LOW, HIGH);
 }
 
-void GxEPD2_1248::ScreenPart::_transfer(uint8_t value)
+void GxEPD2_1248::ScreenPart::_endTransfer()
 {
-  SPI.transfer(value);
+  _epd->_flushTransfer();
+  if (_peer) _peer->_select(HIGH, HIGH);
+  if (_cs >= 0) digitalWrite(_cs, HIGH);
+  _epd->_transport->endTransaction();
 }
 
-void GxEPD2_1248::ScreenPart::_endTransfer()
+void GxEPD2_1248::ScreenPart::_select(uint8_t cs_level, uint8_t dc_level)
 {
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  if (cs_level == HIGH) // deselect before dc changes
+  {
+    if (_cs >= 0) digitalWrite(_cs, HIGH);
+    if (_dc >= 0) digitalWrite(_dc, dc_level);
+  }
+  else
+  {
+    if (_dc >= 0) digitalWrite(_dc, dc_level);
+    if (_cs >= 0) digitalWrite(_cs, LOW);
+  }
 }
@@ -30,6 +30,9 @@ class GxEPD2_1248 : public GxEPD2_EPD
     static const uint16_t power_off_time = 50; // ms, e.g. 41001us
     static const uint16_t full_refresh_time = 4600; // ms, e.g. 4579001us
     static const uint16_t partial_refresh_time = 1600; // ms, e.g. 1525001us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of IL0326
+    static const uint32_t spi_read_clock = 250000; // Hz, bit-banged by _readController()
+    // writes to the four controllers go through the transport, setTransport(); chip select and dc lines are driven here
     // constructors
 #if defined(ESP32)
     // general constructor for use with all parameters on ESP32, e.g. for Waveshare ESP32 driver board mounted on connection board
@@ -93,10 +96,15 @@ class GxEPD2_1248 : public GxEPD2_EPD
     void _writeCommandAll(uint8_t c);
     void _writeDataAll(uint8_t d);
     void _writeDataPGM_All(const uint8_t* data, uint16_t n, int16_t fill_with_zeroes = 0);
+    void _command(uint8_t c); // to the controllers selected
     void _waitWhileAnyBusy(const char* comment = 0, uint16_t busy_time = 5000);
+    // image to all four controllers, M1 and S2 resp. S1 and M2 get one broadcast if their part is identical
+    void _writeImageParts(uint8_t command, const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
+                          int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm);
     void _getMasterTemperature();
   private:
     friend class GDEW1248T3_OTP;
+    // bit-banged on the SPI pins, as _getMasterTemperature(); the command goes through the transport, the read bypasses it
     void _readController(uint8_t cmd, uint8_t* data, uint16_t n, int8_t cs = -1, int8_t dc = -1);
   private:
     int8_t _sck, _miso, _mosi, _dc1, _dc2, _rst1, _rst2;
@@ -114,22 +122,37 @@ class GxEPD2_1248 : public GxEPD2_EPD
     {
       public:
         ScreenPart(uint16_t width, uint16_t height, bool rev_scan, int8_t cs, int8_t dc);
-        void writeScreenBuffer(uint8_t command, uint8_t value = 0xFF); // init controller memory current (default white)
+        void begin(GxEPD2_1248* epd); // bus, transport and SPI settings of epd
+        // peer: controller of the same size, selected together with this one to receive the same data
+        void writeScreenBuffer(uint8_t command, uint8_t value = 0xFF, ScreenPart* peer = 0); // init controller memory current (default white)
         void writeImagePart(uint8_t command, const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
                             int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false);
+#ifdef RPI
+        // clipped window and data of an image part, prepared without using the bus
+        struct Upload
+        {
+          int16_t x, y, w, h; // w = 0 : nothing to write
+          int16_t ram_x; // x in controller memory
+          std::vector<uint8_t> data;
+        };
+        void prepareImagePart(Upload& upload, const uint8_t bitmap[], int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
+                              int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false);
+        void writeUpload(uint8_t command, const Upload& upload, ScreenPart* peer = 0);
+#endif
         void writeCommand(uint8_t c);
         void writeData(uint8_t d);
       private:
         void _setPartialRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
-        void _startTransfer();
-        void _transfer(uint8_t value);
+        void _select(uint8_t cs_level, uint8_t dc_level); // chip select and dc, as peer of another part
+        void _startTransfer(); // data phase with epd->_transfer()
         void _endTransfer();
       public:
         const uint16_t WIDTH, HEIGHT;
       private:
         bool _rev_scan;
         int8_t _cs, _dc;
-        const SPISettings _spi_settings;
+        GxEPD2_1248* _epd;
+        ScreenPart* _peer;
     };
     ScreenPart M1, S1, M2, S2;
 };
@@ -14,7 +14,7 @@
 #include "GxEPD2_154_M10.h"
 
 GxEPD2_154_M10::GxEPD2_154_M10(int8_t cs, int8_t dc, int8_t rst, int8_t busy) :
-  GxEPD2_EPD(cs, dc, rst, busy, LOW, 10000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate)
+  GxEPD2_EPD(cs, dc, rst, busy, LOW, 10000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate, spi_clock)
 {
 }
 
@@ -42,10 +42,7 @@ void GxEPD2_154_M10::writeScreenBufferAgain(uint8_t value)
 void GxEPD2_154_M10::_writeScreenBuffer(uint8_t command, uint8_t value)
 {
   _writeCommand(command);
-  for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(HEIGHT) / 8; i++)
-  {
-    _writeData(value);
-  }
+  _writeDataFill(value, uint32_t(WIDTH) * uint32_t(HEIGHT) / 8);
 }
 
 void GxEPD2_154_M10::writeImage(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
@@ -73,29 +70,14 @@ void GxEPD2_154_M10::_writeImage(uint8_t command, const uint8_t bitmap[], int16_
   _writeCommand(0x91); // partial in
   _setPartialRamArea(x1, y1, w1, h1);
   _writeCommand(command);
+  _startTransfer();
   for (int16_t i = 0; i < h1; i++)
   {
-    for (int16_t j = 0; j < w1 / 8; j++)
-    {
-      uint8_t data;
-      // use wb, h of bitmap for index!
-      int16_t idx = mirror_y ? j + dx / 8 + ((h - 1 - (i + dy))) * wb : j + dx / 8 + (i + dy) * wb;
-      if (pgm)
-      {
-#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
-        data = pgm_read_byte(&bitmap[idx]);
-#else
-        data = bitmap[idx];
-#endif
-      }
-      else
-      {
-        data = bitmap[idx];
-      }
-      if (invert) data = ~data;
-      _writeData(data);
-    }
+    // use wb, h of bitmap for index!
+    int16_t idx = mirror_y ? dx / 8 + ((h - 1 - (i + dy))) * wb : dx / 8 + (i + dy) * wb;
+    _transfer(&bitmap[idx], w1 / 8, invert, pgm);
   }
+  _endTransfer();
   _writeCommand(0x92); // partial out
   delay(1); // yield() to avoid WDT on ESP8266 and ESP32
 }
@@ -133,29 +115,14 @@ void GxEPD2_154_M10::_writeImagePart(uint8_t command, const uint8_t bitmap[], in
   _writeCommand(0x91); // partial in
   _setPartialRamArea(x1, y1, w1, h1);
   _writeCommand(command);
+  _startTransfer();
   for (int16_t i = 0; i < h1; i++)
   {
-    for (int16_t j = 0; j < w1 / 8; j++)
-    {
-      uint8_t data;
-      // use wb_bitmap, h_bitmap of bitmap for index!
-      int16_t idx = mirror_y ? x_part / 8 + j + dx / 8 + ((h_bitmap - 1 - (y_part + i + dy))) * wb_bitmap : x_part / 8 + j + dx / 8 + (y_part + i + dy) * wb_bitmap;
-      if (pgm)
-      {
-#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
-        data = pgm_read_byte(&bitmap[idx]);
-#else
-        data = bitmap[idx];
-#endif
-      }
-      else
-      {
-        data = bitmap[idx];
-      }
-      if (invert) data = ~data;
-      _writeData(data);
-    }
+    // use wb_bitmap, h_bitmap of bitmap for index!
+    int16_t idx = mirror_y ? x_part / 8 + dx / 8 + ((h_bitmap - 1 - (y_part + i + dy))) * wb_bitmap : x_part / 8 + dx / 8 + (y_part + i + dy) * wb_bitmap;
+    _transfer(&bitmap[idx], w1 / 8, invert, pgm);
   }
+  _endTransfer();
   _writeCommand(0x92); // partial out
   delay(1); // yield() to avoid WDT on ESP8266 and ESP32
 }
@@ -290,6 +257,7 @@ void GxEPD2_154_M10::_setPartialRamArea(uint16_t x, uint16_t y, uint16_t w, uint
 
 void GxEPD2_154_M10::_PowerOn()
 {
+  GxEPD2_STATS_TIME(POWER_ON);
   if (!_power_is_on)
   {
     _writeCommand(0x04);
@@ -300,6 +268,7 @@ void GxEPD2_154_M10::_PowerOn()
 
 void GxEPD2_154_M10::_PowerOff()
 {
+  GxEPD2_STATS_TIME(POWER_OFF);
   if (_power_is_on)
   {
     _writeCommand(0x02);
@@ -399,12 +368,14 @@ void GxEPD2_154_M10::_Init_Part()
 
 void GxEPD2_154_M10::_Update_Full()
 {
+  GxEPD2_STATS_COUNT(full_refreshes);
   _writeCommand(0x12);
   _waitWhileBusy("_Update_Full", full_refresh_time);
 }
 
 void GxEPD2_154_M10::_Update_Part()
 {
+  GxEPD2_STATS_COUNT(partial_refreshes);
   _writeCommand(0x12);
   _waitWhileBusy("_Update_Part", partial_refresh_time);
 }
@@ -30,6 +30,7 @@ class GxEPD2_154_M10 : public GxEPD2_EPD
     static const uint16_t power_off_time = 50; // ms, e.g. 39592us
     static const uint16_t full_refresh_time = 4000; // ms, e.g. 3665378us
     static const uint16_t partial_refresh_time = 1700; // ms, e.g. 1635335us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of UC8151D
     // constructor
     GxEPD2_154_M10(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
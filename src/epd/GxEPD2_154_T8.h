@@ -30,6 +30,7 @@ class GxEPD2_154_T8 : public GxEPD2_EPD
     static const uint16_t power_off_time = 20; // ms, e.g. 19339us
     static const uint16_t full_refresh_time = 1600; // ms, e.g. 1525624us
     static const uint16_t partial_refresh_time = 350; // ms, e.g. 349355us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of IL0373
     // constructor
     GxEPD2_154_T8(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
@@ -29,6 +29,7 @@ class GxEPD2_213_B72 : public GxEPD2_EPD
     static const uint16_t power_off_time = 180; // ms, e.g. 172648us
     static const uint16_t full_refresh_time = 1700; // ms, e.g. 1686008us
     static const uint16_t partial_refresh_time = 200; // ms, e.g. 192385us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of IL3897
     // constructor
     GxEPD2_213_B72(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
@@ -30,6 +30,7 @@ class GxEPD2_213_B73 : public GxEPD2_EPD
     static const uint16_t power_off_time = 250; // ms, e.g. 229774us
     static const uint16_t full_refresh_time = 4000; // ms, e.g. 3820212us
     static const uint16_t partial_refresh_time = 200; // ms, e.g. 199006us
+    static const uint32_t spi_clock = 20000000; // Hz, max. write clock of SSD1675B
     // constructor
     GxEPD2_213_B73(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
@@ -30,6 +30,7 @@ class GxEPD2_213_B74 : public GxEPD2_EPD
     static const uint16_t power_off_time = 150; // ms, e.g. 140344us
     static const uint16_t full_refresh_time = 3600; // ms, e.g. 3501806us
     static const uint16_t partial_refresh_time = 500; // ms, e.g. 455406us
+    static const uint32_t spi_clock = 20000000; // Hz, max. write clock of SSD1680
     // constructor
     GxEPD2_213_B74(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
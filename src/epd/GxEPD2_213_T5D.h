@@ -29,6 +29,7 @@ class GxEPD2_213_T5D : public GxEPD2_EPD
     static const uint16_t power_off_time = 50; // ms, e.g. 39131us
     static const uint16_t full_refresh_time = 4700; // ms, e.g. 4615853us
     static const uint16_t partial_refresh_time = 750; // ms, e.g. 699013us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of UC8151D
     // constructor
     GxEPD2_213_T5D(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
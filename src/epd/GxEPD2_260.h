@@ -31,6 +31,7 @@ class GxEPD2_260 : public GxEPD2_EPD
     static const uint16_t power_off_time = 20; // ms, e.g. 19748us
     static const uint16_t full_refresh_time = 1600; // ms, e.g. 1543246us
     static const uint16_t partial_refresh_time = 1300; // ms, e.g. 1228991us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of IL0373
     // constructor
     GxEPD2_260(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
@@ -30,6 +30,7 @@ class GxEPD2_290_M06 : public GxEPD2_EPD
     static const uint16_t power_off_time = 50; // ms, e.g. 39163us
     static const uint16_t full_refresh_time = 3600; // ms, e.g. 3527448us
     static const uint16_t partial_refresh_time = 600; // ms, e.g. 537169us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of UC8151
     // constructor
     GxEPD2_290_M06(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
@@ -29,6 +29,7 @@ class GxEPD2_290_T5 : public GxEPD2_EPD
     static const uint16_t power_off_time = 250; // ms, e.g. 20759us
     static const uint16_t full_refresh_time = 2100; // ms, e.g. 2056899us
     static const uint16_t partial_refresh_time = 400; // ms, e.g. 353649us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of IL0373
     // constructor
     GxEPD2_290_T5(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
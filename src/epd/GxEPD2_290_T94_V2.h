@@ -33,6 +33,7 @@ class GxEPD2_290_T94_V2 : public GxEPD2_EPD
     static const uint16_t power_off_time = 150; // ms, e.g. 140350us
     static const uint16_t full_refresh_time = 4100; // ms, e.g. 4011934us
     static const uint16_t partial_refresh_time = 750; // ms, e.g. 736721us
+    static const uint32_t spi_clock = 20000000; // Hz, max. write clock of SSD1680
     // constructor
     GxEPD2_290_T94_V2(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
@@ -31,6 +31,7 @@ class GxEPD2_371 : public GxEPD2_EPD
     static const uint16_t power_off_time = 50; // ms, e.g. 39563us
     static const uint16_t full_refresh_time = 3000; // ms, e.g. 2953630us
     static const uint16_t partial_refresh_time = 1500; // ms, e.g. 1482735us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of IL0324
     // constructor
     GxEPD2_371(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
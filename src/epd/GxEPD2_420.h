@@ -30,6 +30,7 @@ class GxEPD2_420 : public GxEPD2_EPD
     static const uint16_t power_off_time = 20; // ms, e.g. 19285us
     static const uint16_t full_refresh_time = 1600; // ms, e.g. 1545659us
     static const uint16_t partial_refresh_time = 600; // ms, e.g. 563754us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of IL0398
     // constructor
     GxEPD2_420(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
@@ -31,6 +31,7 @@ class GxEPD2_420_M01 : public GxEPD2_EPD
     static const uint16_t power_off_time = 20; // ms, e.g. 19259us
     static const uint16_t full_refresh_time = 5000; // ms, e.g. 4653207us
     static const uint16_t partial_refresh_time = hasPartialUpdate ? 1200 : full_refresh_time; // ms, e.g. 1128540us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of UC8176
     // constructor
     GxEPD2_420_M01(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
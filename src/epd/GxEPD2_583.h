@@ -29,6 +29,7 @@ class GxEPD2_583 : public GxEPD2_EPD
     static const uint16_t power_off_time = 30; // ms, e.g. 20291us
     static const uint16_t full_refresh_time = 15000; // ms, e.g. 14598868us
     static const uint16_t partial_refresh_time = 15000; // ms, e.g. 14598868us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of IL0371
     // constructor
     GxEPD2_583(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
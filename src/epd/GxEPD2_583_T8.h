@@ -31,6 +31,7 @@ class GxEPD2_583_T8 : public GxEPD2_EPD
     static const uint16_t power_off_time = 42; // ms, e.g. 40033us
     static const uint16_t full_refresh_time = 4200; // ms, e.g. 4108238us
     static const uint16_t partial_refresh_time = 1600; // ms, e.g. 1584124us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of GD7965
     // constructor
     GxEPD2_583_T8(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
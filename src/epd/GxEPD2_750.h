@@ -29,6 +29,7 @@ class GxEPD2_750 : public GxEPD2_EPD
     static const uint16_t power_off_time = 50; // ms, e.g. 40578us
     static const uint16_t full_refresh_time = 4500; // ms, e.g. 4273474us
     static const uint16_t partial_refresh_time = 4500; // ms, e.g. 4273474us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of IL0371
     // constructor
     GxEPD2_750(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
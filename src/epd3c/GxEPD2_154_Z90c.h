@@ -29,6 +29,7 @@ class GxEPD2_154_Z90c : public GxEPD2_EPD
     static const uint16_t power_off_time = 250; // ms, e.g. 230321us
     static const uint16_t full_refresh_time = 14000; // ms, e.g. 13608449us
     static const uint16_t partial_refresh_time = 14000; // ms, e.g. 13608449us
+    static const uint32_t spi_clock = 20000000; // Hz, max. write clock of SSD1682
     // constructor
     GxEPD2_154_Z90c(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
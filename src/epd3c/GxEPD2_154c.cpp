@@ -21,7 +21,7 @@ const uint8_t GxEPD2_154c::bw2grey[] =
 };
 
 GxEPD2_154c::GxEPD2_154c(int8_t cs, int8_t dc, int8_t rst, int8_t busy) :
-  GxEPD2_EPD(cs, dc, rst, busy, LOW, 20000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate)
+  GxEPD2_EPD(cs, dc, rst, busy, LOW, 20000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate, spi_clock)
 {
   _paged = false;
   _second_phase = false;
@@ -50,16 +50,15 @@ void GxEPD2_154c::clearScreen(uint8_t black_value, uint8_t color_value)
 {
   _Init_Full();
   _writeCommand(0x10);
+  _startTransfer();
   for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(HEIGHT) / 8; i++)
   {
-    _writeData(bw2grey[(black_value & 0xF0) >> 4]);
-    _writeData(bw2grey[black_value & 0x0F]);
+    _transfer(bw2grey[(black_value & 0xF0) >> 4]);
+    _transfer(bw2grey[black_value & 0x0F]);
   }
+  _endTransfer();
   _writeCommand(0x13);
-  for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(HEIGHT) / 8; i++)
-  {
-    _writeData(color_value);
-  }
+  _writeDataFill(color_value, uint32_t(WIDTH) * uint32_t(HEIGHT) / 8);
   _Update_Full();
 }
 
@@ -72,16 +71,15 @@ void GxEPD2_154c::writeScreenBuffer(uint8_t black_value, uint8_t color_value)
 {
   _Init_Full();
   _writeCommand(0x10);
+  _startTransfer();
   for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(HEIGHT) / 8; i++)
   {
-    _writeData(bw2grey[(black_value & 0xF0) >> 4]);
-    _writeData(bw2grey[black_value & 0x0F]);
+    _transfer(bw2grey[(black_value & 0xF0) >> 4]);
+    _transfer(bw2grey[black_value & 0x0F]);
   }
+  _endTransfer();
   _writeCommand(0x13);
-  for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(HEIGHT) / 8; i++)
-  {
-    _writeData(color_value);
-  }
+  _writeDataFill(color_value, uint32_t(WIDTH) * uint32_t(HEIGHT) / 8);
 }
 
 void GxEPD2_154c::writeImage(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
@@ -99,11 +97,13 @@ void GxEPD2_154c::writeImage(const uint8_t* black, const uint8_t* color, int16_t
     //Serial.println("paged");
     if (!_second_phase)
     {
+      _startTransfer();
       for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(h) / 8; i++)
       {
-        _writeData(bw2grey[(black[i] & 0xF0) >> 4]);
-        _writeData(bw2grey[black[i] & 0x0F]);
+        _transfer(bw2grey[(black[i] & 0xF0) >> 4]);
+        _transfer(bw2grey[black[i] & 0x0F]);
       }
+      _endTransfer();
       if (y + h == HEIGHT) // last page
       {
         //Serial.println("phase 1 ended");
@@ -113,10 +113,12 @@ void GxEPD2_154c::writeImage(const uint8_t* black, const uint8_t* color, int16_t
     }
     else
     {
+      _startTransfer();
       for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(h) / 8; i++)
       {
-        _writeData(color[i]);
+        _transfer(color[i]);
       }
+      _endTransfer();
       if (y + h == HEIGHT) // last page
       {
         //Serial.println("phase 2 ended");
@@ -134,6 +136,7 @@ void GxEPD2_154c::writeImage(const uint8_t* black, const uint8_t* color, int16_t
     if ((w <= 0) || (h <= 0)) return;
     _Init_Full();
     _writeCommand(0x10);
+    _startTransfer();
     for (int16_t i = 0; i < HEIGHT; i++)
     {
       for (int16_t j = 0; j < WIDTH; j += 8)
@@ -159,12 +162,14 @@ void GxEPD2_154c::writeImage(const uint8_t* black, const uint8_t* color, int16_t
             if (invert) data = ~data;
           }
         }
-        //_writeData(data);
-        _writeData(bw2grey[(data & 0xF0) >> 4]);
-        _writeData(bw2grey[data & 0x0F]);
+        //_transfer(data);
+        _transfer(bw2grey[(data & 0xF0) >> 4]);
+        _transfer(bw2grey[data & 0x0F]);
       }
     }
+    _endTransfer();
     _writeCommand(0x13);
+    _startTransfer();
     for (int16_t i = 0; i < HEIGHT; i++)
     {
       for (int16_t j = 0; j < WIDTH; j += 8)
@@ -190,9 +195,10 @@ void GxEPD2_154c::writeImage(const uint8_t* black, const uint8_t* color, int16_t
             if (invert) data = ~data;
           }
         }
-        _writeData(data);
+        _transfer(data);
       }
     }
+    _endTransfer();
   }
   delay(1); // yield() to avoid WDT on ESP8266 and ESP32
 }
@@ -227,6 +233,7 @@ void GxEPD2_154c::writeImagePart(const uint8_t* black, const uint8_t* color, int
   if ((w1 <= 0) || (h1 <= 0)) return;
   _Init_Full();
   _writeCommand(0x10);
+  _startTransfer();
   for (int16_t i = 0; i < HEIGHT; i++)
   {
     for (int16_t j = 0; j < WIDTH; j += 8)
@@ -254,12 +261,14 @@ void GxEPD2_154c::writeImagePart(const uint8_t* black, const uint8_t* color, int
           if (invert) data = ~data;
         }
       }
-      //_writeData(data);
-      _writeData(bw2grey[(data & 0xF0) >> 4]);
-      _writeData(bw2grey[data & 0x0F]);
+      //_transfer(data);
+      _transfer(bw2grey[(data & 0xF0) >> 4]);
+      _transfer(bw2grey[data & 0x0F]);
     }
   }
+  _endTransfer();
   _writeCommand(0x13);
+  _startTransfer();
   for (int16_t i = 0; i < HEIGHT; i++)
   {
     for (int16_t j = 0; j < WIDTH; j += 8)
@@ -286,9 +295,10 @@ void GxEPD2_154c::writeImagePart(const uint8_t* black, const uint8_t* color, int
           if (invert) data = ~data;
         }
       }
-      _writeData(data);
+      _transfer(data);
     }
   }
+  _endTransfer();
   delay(1); // yield() to avoid WDT on ESP8266 and ESP32
 }
 
@@ -366,6 +376,7 @@ void GxEPD2_154c::_setPartialRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_
 
 void GxEPD2_154c::_PowerOn()
 {
+  GxEPD2_STATS_TIME(POWER_ON);
   if (!_power_is_on)
   {
     _writeCommand(0x04);
@@ -376,6 +387,7 @@ void GxEPD2_154c::_PowerOn()
 
 void GxEPD2_154c::_PowerOff()
 {
+  GxEPD2_STATS_TIME(POWER_OFF);
   _writeCommand(0x50);
   _writeData(0x17);    //BD floating
   _writeCommand(0x82);     //to solve Vcom drop
@@ -465,12 +477,14 @@ void GxEPD2_154c::_Init_Part()
 
 void GxEPD2_154c::_Update_Full()
 {
+  GxEPD2_STATS_COUNT(full_refreshes);
   _writeCommand(0x12); //display refresh
   _waitWhileBusy("_Update_Full", full_refresh_time);
 }
 
 void GxEPD2_154c::_Update_Part()
 {
+  GxEPD2_STATS_COUNT(partial_refreshes);
   _writeCommand(0x12); //display refresh
   _waitWhileBusy("_Update_Part", partial_refresh_time);
 }
@@ -13,7 +13,7 @@
 #include "GxEPD2_213c.h"
 
 GxEPD2_213c::GxEPD2_213c(int8_t cs, int8_t dc, int8_t rst, int8_t busy) :
-  GxEPD2_EPD(cs, dc, rst, busy, LOW, 20000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate)
+  GxEPD2_EPD(cs, dc, rst, busy, LOW, 20000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate, spi_clock)
 {
 }
 
@@ -29,15 +29,9 @@ void GxEPD2_213c::clearScreen(uint8_t black_value, uint8_t color_value)
   _writeCommand(0x91);	// Partial In (PTIN)
   _setPartialRamArea(0, 0, WIDTH, HEIGHT);
   _writeCommand(0x10);
-  for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(HEIGHT) / 8; i++)
-  {
-    _writeData(black_value);
-  }
+  _writeDataFill(black_value, uint32_t(WIDTH) * uint32_t(HEIGHT) / 8);
   _writeCommand(0x13);
-  for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(HEIGHT) / 8; i++)
-  {
-    _writeData(color_value);
-  }
+  _writeDataFill(color_value, uint32_t(WIDTH) * uint32_t(HEIGHT) / 8);
   _Update_Part();
   _writeCommand(0x92); // Partial Out (PTOUT)
 }
@@ -54,14 +48,9 @@ void GxEPD2_213c::writeScreenBuffer(uint8_t black_value, uint8_t color_value)
   _writeCommand(0x91);	// Partial In (PTIN)
   _setPartialRamArea(0, 0, WIDTH, HEIGHT);
   _writeCommand(0x10);
-  for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(HEIGHT) / 8; i++)
-  {
-    _writeData(black_value);
-  }
+  _writeDataFill(black_value, uint32_t(WIDTH) * uint32_t(HEIGHT) / 8);
   _writeCommand(0x13);	// Data Start Transmission 2 (DTM2)
-  for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(HEIGHT) / 8; i++) {
-    _writeData(color_value);
-  }
+  _writeDataFill(color_value, uint32_t(WIDTH) * uint32_t(HEIGHT) / 8);
   _writeCommand(0x92); // Partial Out (PTOUT)
 }
 
@@ -90,45 +79,35 @@ void GxEPD2_213c::writeImage(const uint8_t* black, const uint8_t* color, int16_t
   _writeCommand(0x91);	// Partial In (PTIN)
   _setPartialRamArea(x1, y1, w1, h1);
   _writeCommand(0x10);	// Data Start Transmission 1 (DTM1)
+  _startTransfer();
   for (int16_t i = 0; i < h1; i++) {
-    for (int16_t j = 0; j < w1 / 8; j++) {
-      uint8_t data = 0xFF;
-      if (black)
-      {
-        // use wb, h of bitmap for index!
-        int16_t idx = mirror_y ? j + dx / 8 + ((h - 1 - (i + dy))) * wb : j + dx / 8 + (i + dy) * wb;
-        data = pgm ?
-#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
-          pgm_read_byte(&black[idx])
-#else
-          black[idx]
-#endif
-        : black[idx];
-        if (invert) data = ~data;
-      }
-      _writeData(data);
+    if (black)
+    {
+      // use wb, h of bitmap for index!
+      int16_t idx = mirror_y ? dx / 8 + ((h - 1 - (i + dy))) * wb : dx / 8 + (i + dy) * wb;
+      _transfer(&black[idx], w1 / 8, invert, pgm);
+    }
+    else
+    {
+      _transferFill(0xFF, w1 / 8);
     }
   }
+  _endTransfer();
   _writeCommand(0x13);	// Data Start Transmission 2 (DTM2)
+  _startTransfer();
   for (int16_t i = 0; i < h1; i++) {
-    for (int16_t j = 0; j < w1 / 8; j++) {
-      uint8_t data = 0xFF;
-      if (color)
-      {
-        // use wb, h of bitmap for index!
-        int16_t idx = mirror_y ? j + dx / 8 + ((h - 1 - (i + dy))) * wb : j + dx / 8 + (i + dy) * wb;
-        data = pgm ?
-#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
-          pgm_read_byte(&color[idx])
-#else
-          color[idx]
-#endif
-        : color[idx];
-        if (invert) data = ~data;
-      }
-      _writeData(data);
+    if (color)
+    {
+      // use wb, h of bitmap for index!
+      int16_t idx = mirror_y ? dx / 8 + ((h - 1 - (i + dy))) * wb : dx / 8 + (i + dy) * wb;
+      _transfer(&color[idx], w1 / 8, invert, pgm);
+    }
+    else
+    {
+      _transferFill(0xFF, w1 / 8);
     }
   }
+  _endTransfer();
   _writeCommand(0x92); // Partial Out (PTOUT)
   delay(1); // yield() to avoid WDT on ESP8266 and ESP32
 }
@@ -166,42 +145,28 @@ void GxEPD2_213c::writeImagePart(const uint8_t* black, const uint8_t* color, int
   _writeCommand(0x91);	// Partial In (PTIN)
   _setPartialRamArea(x1, y1, w1, h1);
   _writeCommand(0x10);	// Data Start Transmission 1 (DTM1)
+  _startTransfer();
   for (int16_t i = 0; i < h1; i++) {
-    for (int16_t j = 0; j < w1 / 8; j++) {
-      uint8_t data;
-      // use wb_bitmap, h_bitmap of bitmap for index!
-      int16_t idx = mirror_y ? x_part / 8 + j + dx / 8 + ((h_bitmap - 1 - (y_part + i + dy))) * wb_bitmap : x_part / 8 + j + dx / 8 + (y_part + i + dy) * wb_bitmap;
-      data = pgm ?
-#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
-        pgm_read_byte(&black[idx])
-#else
-        black[idx]
-#endif
-      : black[idx];
-      if (invert) data = ~data;
-      _writeData(data);
-    }
+    // use wb_bitmap, h_bitmap of bitmap for index!
+    int16_t idx = mirror_y ? x_part / 8 + dx / 8 + ((h_bitmap - 1 - (y_part + i + dy))) * wb_bitmap : x_part / 8 + dx / 8 + (y_part + i + dy) * wb_bitmap;
+    _transfer(&black[idx], w1 / 8, invert, pgm);
   }
+  _endTransfer();
   _writeCommand(0x13);	// Data Start Transmission 2 (DTM2)
+  _startTransfer();
   for (int16_t i = 0; i < h1; i++) {
-    for (int16_t j = 0; j < w1 / 8; j++) {
-      uint8_t data = 0xFF;
-      if (color)
-      {
-        // use wb_bitmap, h_bitmap of bitmap for index!
-        int16_t idx = mirror_y ? x_part / 8 + j + dx / 8 + ((h_bitmap - 1 - (y_part + i + dy))) * wb_bitmap : x_part / 8 + j + dx / 8 + (y_part + i + dy) * wb_bitmap;
-        data = pgm ?
-#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
-          pgm_read_byte(&color[idx])
-#else
-          color[idx]
-#endif
-        : color[idx];
-        if (invert) data = ~data;
-      }
-      _writeData(data);
+    if (color)
+    {
+      // use wb_bitmap, h_bitmap of bitmap for index!
+      int16_t idx = mirror_y ? x_part / 8 + dx / 8 + ((h_bitmap - 1 - (y_part + i + dy))) * wb_bitmap : x_part / 8 + dx / 8 + (y_part + i + dy) * wb_bitmap;
+      _transfer(&color[idx], w1 / 8, invert, pgm);
+    }
+    else
+    {
+      _transferFill(0xFF, w1 / 8);
     }
   }
+  _endTransfer();
   _writeCommand(0x92); // Partial Out (PTOUT)
   delay(1); // yield() to avoid WDT on ESP8266 and ESP32
 }
@@ -308,6 +273,7 @@ void GxEPD2_213c::_setPartialRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_
 
 void GxEPD2_213c::_PowerOn()
 {
+  GxEPD2_STATS_TIME(POWER_ON);
   if (!_power_is_on)
   {
     _writeCommand(0x04);
@@ -317,6 +283,7 @@ void GxEPD2_213c::_PowerOn()
 }
 
 void GxEPD2_213c::_PowerOff() {
+  GxEPD2_STATS_TIME(POWER_OFF);
   _writeCommand(0x02); // Power Off (POF)
   _waitWhileBusy("_PowerOff", power_off_time);
   _power_is_on = false;
@@ -369,11 +336,13 @@ void GxEPD2_213c::_Init_Part()
 }
 
 void GxEPD2_213c::_Update_Full() {
+  GxEPD2_STATS_COUNT(full_refreshes);
   _writeCommand(0x12); 	// Display Refresh (DRF)
   _waitWhileBusy("_Update_Full", full_refresh_time);
 }
 
 void GxEPD2_213c::_Update_Part() {
+  GxEPD2_STATS_COUNT(partial_refreshes);
   _writeCommand(0x12); 	// Display Refresh (DRF)
   _waitWhileBusy("_Update_Part", partial_refresh_time);
 }
@@ -29,6 +29,7 @@ class GxEPD2_290_C90c : public GxEPD2_EPD
     static const uint16_t power_off_time = 150; // ms, e.g. 139874us
     static const uint16_t full_refresh_time = 27000; // ms, e.g. 26130024us
     static const uint16_t partial_refresh_time = 27000; // ms, e.g. 26130024us
+    static const uint32_t spi_clock = 20000000; // Hz, max. write clock of SSD1680
     // constructor
     GxEPD2_290_C90c(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
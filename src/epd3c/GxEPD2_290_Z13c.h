@@ -30,6 +30,7 @@ class GxEPD2_290_Z13c : public GxEPD2_EPD
     static const uint16_t power_off_time = 50; // ms, e.g. 39037us
     static const uint16_t full_refresh_time = 18000; // ms, e.g. 17812004us
     static const uint16_t partial_refresh_time = 18000; // ms, e.g. 17812004us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of UC8151D
     // constructor
     GxEPD2_290_Z13c(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
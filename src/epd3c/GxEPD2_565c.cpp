@@ -15,7 +15,7 @@
 #include "GxEPD2_565c.h"
 
 GxEPD2_565c::GxEPD2_565c(int8_t cs, int8_t dc, int8_t rst, int8_t busy) :
-  GxEPD2_EPD(cs, dc, rst, busy, LOW, 25000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate)
+  GxEPD2_EPD(cs, dc, rst, busy, LOW, 25000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate, spi_clock)
 {
   _paged = false;
 }
@@ -42,11 +42,8 @@ void GxEPD2_565c::writeScreenBuffer(uint8_t black_value, uint8_t color_value)
   _Init_Full();
   _writeCommand(0x10);
   _startTransfer();
-  for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(HEIGHT) / 2; i++)
-  {
-    //_transfer(0x11);
-    _transfer(0xFF == black_value ? 0x11 : black_value);
-  }
+  //_transferFill(0x11, uint32_t(WIDTH) * uint32_t(HEIGHT) / 2);
+  _transferFill(0xFF == black_value ? 0x11 : black_value, uint32_t(WIDTH) * uint32_t(HEIGHT) / 2);
   _endTransfer();
 }
 
@@ -64,9 +61,8 @@ void GxEPD2_565c::writeImage(const uint8_t bitmap[], int16_t x, int16_t y, int16
       uint8_t data = bitmap[i];
       for (int16_t k = 0; k < 4; k++)
       {
-        uint8_t data2 = (data & 0x80 ? 0x10 : 0x00) | (data & 0x40 ? 0x01 : 0x00);
+        _transfer((data & 0x80 ? 0x10 : 0x00) | (data & 0x40 ? 0x01 : 0x00));
         data <<= 2;
-        _transfer(data2);
       }
     }
     _endTransfer();
@@ -110,9 +106,8 @@ void GxEPD2_565c::writeImage(const uint8_t bitmap[], int16_t x, int16_t y, int16
         }
         for (int16_t k = 0; k < 4; k++)
         {
-          uint8_t data2 = (data & 0x80 ? 0x10 : 0x00) | (data & 0x40 ? 0x01 : 0x00);
+          _transfer((data & 0x80 ? 0x10 : 0x00) | (data & 0x40 ? 0x01 : 0x00));
           data <<= 2;
-          _transfer(data2);
         }
       }
     }
@@ -266,9 +261,8 @@ void GxEPD2_565c::writeImagePart(const uint8_t bitmap[], int16_t x_part, int16_t
       }
       for (int16_t k = 0; k < 4; k++)
       {
-        uint8_t data2 = (data & 0x80 ? 0x10 : 0x00) | (data & 0x40 ? 0x01 : 0x00);
+        _transfer((data & 0x80 ? 0x10 : 0x00) | (data & 0x40 ? 0x01 : 0x00));
         data <<= 2;
-        _transfer(data2);
       }
     }
   }
@@ -367,10 +361,9 @@ void GxEPD2_565c::writeNative(const uint8_t* data1, const uint8_t* data2, int16_
     {
       //Serial.println("paged");
       _startTransfer();
-      for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(h) / 2; i++)
+      for (int16_t i = 0; i < h; i++)
       {
-        uint8_t data = data1[i];
-        _transfer(data);
+        _transfer(&data1[uint32_t(i) * WIDTH / 2], WIDTH / 2);
       }
       _endTransfer();
       if (y + h == HEIGHT) // last page
@@ -551,6 +544,7 @@ void GxEPD2_565c::setPaged()
 
 void GxEPD2_565c::_PowerOn()
 {
+  GxEPD2_STATS_TIME(POWER_ON);
   if (!_power_is_on)
   {
     _writeCommand(0x04);
@@ -561,6 +555,7 @@ void GxEPD2_565c::_PowerOn()
 
 void GxEPD2_565c::_PowerOff()
 {
+  GxEPD2_STATS_TIME(POWER_OFF);
   if (_power_is_on)
   {
     _writeCommand(0x02);
@@ -621,12 +616,14 @@ void GxEPD2_565c::_Init_Part()
 
 void GxEPD2_565c::_Update_Full()
 {
+  GxEPD2_STATS_COUNT(full_refreshes);
   _writeCommand(0x12); // Display Refresh
   _waitWhileBusy("_Update_Full", full_refresh_time);
 }
 
 void GxEPD2_565c::_Update_Part()
 {
+  GxEPD2_STATS_COUNT(partial_refreshes);
   _writeCommand(0x12); // Display Refresh
   _waitWhileBusy("_Update_Part", partial_refresh_time);
 }
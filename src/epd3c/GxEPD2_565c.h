@@ -30,6 +30,7 @@ class GxEPD2_565c : public GxEPD2_EPD
     static const uint16_t power_off_time = 100; // ms, e.g. 60001us
     static const uint16_t full_refresh_time = 12000; // ms, e.g. 11354001us
     static const uint16_t partial_refresh_time = 12000; // ms, e.g. 11354001us
+    static const uint32_t spi_clock = 4000000; // Hz, controller unknown
     // constructor
     GxEPD2_565c(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
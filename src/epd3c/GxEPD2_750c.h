@@ -29,6 +29,7 @@ class GxEPD2_750c : public GxEPD2_EPD
     static const uint16_t power_off_time = 50; // ms, e.g. 40579us
     static const uint16_t full_refresh_time = 32000; // ms, e.g. 31094507us
     static const uint16_t partial_refresh_time = 32000; // ms, e.g. 31094507us
+    static const uint32_t spi_clock = 10000000; // Hz, max. write clock of IL0371
     // constructor
     GxEPD2_750c(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
     // methods (virtual)
@@ -31,6 +31,7 @@ class GxEPD2_750c_Z90 : public GxEPD2_EPD
     static const uint16_t power_off_time = 250; // ms, e.g. 222001us
     static const uint16_t full_refresh_time = 25000; // ms, e.g. 22780001us
     static const uint16_t partial_refresh_time = 25000; // ms, e.g. 22780001us
+    static const uint32_t spi_clock = 20000000; // Hz, max. write clock of SSD1677
     static const uint8_t entry_mode = 0x03; // 0x03:normal, 0x00:rotated 180, 0x01,0x02:flipped
     // constructor
     GxEPD2_750c_Z90(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
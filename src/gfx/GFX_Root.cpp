@@ -970,7 +970,7 @@ void GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16
         }
         if (bg != color) { // If opaque, draw vertical line for last column
             if (size_x == 1 && size_y == 1)
-                writeFillRect(x + 5, y, 8, 1, bg);
+                writeFillRect(x + 5, y, 1, 8, bg);
             else
                 writeFillRect(x + 5 * size_x, y, size_x, 8 * size_y, bg);
         }
@@ -56,9 +56,9 @@
 #define LISAR (MCSR_BASE_ADDR + 0x0008)
 
 GxEPD2_it60_1448x1072::GxEPD2_it60_1448x1072(int8_t cs, int8_t dc, int8_t rst, int8_t busy) :
-  GxEPD2_EPD(cs, dc, rst, busy, LOW, 10000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate),
-  _spi_settings(24000000, MSBFIRST, SPI_MODE0),
-  _spi_settings_for_read(1000000, MSBFIRST, SPI_MODE0)
+  GxEPD2_EPD(cs, dc, rst, busy, LOW, 10000000, WIDTH, HEIGHT, panel, hasColor, hasPartialUpdate, hasFastPartialUpdate, spi_clock),
+  _spi_settings_for_read(spi_read_clock, MSBFIRST, SPI_MODE0),
+  _partial_waveform(DU), _ghosting_limit(20), _fast_refreshes(0), _a2_mode(A2), _grey_loaded(false)
 {
 }
 
@@ -95,6 +95,7 @@ void GxEPD2_it60_1448x1072::init(uint32_t serial_diag_bitrate, bool initial, uin
     printf("FW Version = %s\r\n", (uint8_t*)IT8951DevInfo.usFWVersion);
     printf("LUT Version = %s\r\n", (uint8_t*)IT8951DevInfo.usLUTVersion);
   }
+  _a2_mode = strncmp((const char*)IT8951DevInfo.usLUTVersion, "M641", 4) == 0 ? 4 : A2;
   //Set to Enable I80 Packed mode
   _IT8951WriteReg(I80CPCR, 0x0001);
   if (VCOM != _IT8951GetVCOM())
@@ -111,20 +112,13 @@ void GxEPD2_it60_1448x1072::clearScreen(uint8_t value)
   if (_initial_refresh) _Init_Full();
   else _Init_Part();
   _initial_refresh = false;
-  _setPartialRamArea(0, 0, WIDTH, HEIGHT);
-  SPI.beginTransaction(_spi_settings);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
+  _grey_loaded = (value != 0x00) && (value != 0xFF);
+  _setPartialRamArea(0, 0, WIDTH, HEIGHT, IT8951_8BPP);
+  _transport->beginTransaction(_spi_settings);
   _transfer16(0x0000); // preamble for write data
   _waitWhileBusy2("clearScreen preamble", default_wait_time);
-  for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(HEIGHT); i++)
-  {
-    SPI.transfer(value);
-#if defined(ESP8266) || defined(ESP32)
-    if (0 == i % 10000) yield();
-#endif
-  }
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _transferFill(value, uint32_t(WIDTH) * uint32_t(HEIGHT));
+  _transport->endTransaction();
   _writeCommand16(IT8951_TCON_LD_IMG_END);
   _waitWhileBusy2("clearScreen load end", default_wait_time);
   _refresh(0, 0, WIDTH, HEIGHT, false);
@@ -140,20 +134,13 @@ void GxEPD2_it60_1448x1072::_writeScreenBuffer(uint8_t value)
 {
   _initial_write = false; // initial full screen buffer clean done
   if (!_using_partial_mode) _Init_Part();
-  _setPartialRamArea(0, 0, WIDTH, HEIGHT);
-  SPI.beginTransaction(_spi_settings);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
+  _grey_loaded = (value != 0x00) && (value != 0xFF);
+  _setPartialRamArea(0, 0, WIDTH, HEIGHT, IT8951_8BPP);
+  _transport->beginTransaction(_spi_settings);
   _transfer16(0x0000); // preamble for write data
   _waitWhileBusy2("clearScreen preamble", default_wait_time);
-  for (uint32_t i = 0; i < uint32_t(WIDTH) * uint32_t(HEIGHT); i++)
-  {
-    SPI.transfer(value);
-#if defined(ESP8266) || defined(ESP32)
-    if (0 == i % 10000) yield();
-#endif
-  }
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _transferFill(value, uint32_t(WIDTH) * uint32_t(HEIGHT));
+  _transport->endTransaction();
   _writeCommand16(IT8951_TCON_LD_IMG_END);
   _waitWhileBusy2("_writeScreenBuffer load end", default_wait_time);
 }
@@ -175,11 +162,11 @@ void GxEPD2_it60_1448x1072::writeImage(const uint8_t bitmap[], int16_t x, int16_
   h1 -= dy;
   if ((w1 <= 0) || (h1 <= 0)) return;
   if (!_using_partial_mode) _Init_Part();
-  _setPartialRamArea(x1, y1, w1, h1);
-  SPI.beginTransaction(_spi_settings);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
+  _setPartialRamArea(x1, y1, w1, h1, IT8951_2BPP);
+  _transport->beginTransaction(_spi_settings);
   _transfer16(0x0000); // preamble for write data
   _waitWhileBusy2("writeImage preamble", default_wait_time);
+  uint8_t row[WIDTH / 4]; // 2bpp
   for (int16_t i = 0; i < h1; i++)
   {
     for (int16_t j = 0; j < w1 / 8; j++)
@@ -200,14 +187,17 @@ void GxEPD2_it60_1448x1072::writeImage(const uint8_t bitmap[], int16_t x, int16_
         data = bitmap[idx];
       }
       if (invert) data = ~data;
-      _send8pixel(~data);
+      uint16_t pixels = _pack2bpp(data);
+      row[2 * j] = pixels >> 8;
+      row[2 * j + 1] = pixels & 0xFF;
     }
+    GxEPD2_STATS_DATA(w1 / 4);
+    _transport->writeData(row, w1 / 4);
 #if defined(ESP8266) || defined(ESP32)
     yield();
 #endif
   }
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _transport->endTransaction();
   _writeCommand16(IT8951_TCON_LD_IMG_END);
   _waitWhileBusy2("writeImage load end", default_wait_time);
   delay(1); // yield() to avoid WDT on ESP8266 and ESP32
@@ -237,11 +227,11 @@ void GxEPD2_it60_1448x1072::writeImagePart(const uint8_t bitmap[], int16_t x_par
   h1 -= dy;
   if ((w1 <= 0) || (h1 <= 0)) return;
   if (!_using_partial_mode) _Init_Part();
-  _setPartialRamArea(x1, y1, w1, h1);
-  SPI.beginTransaction(_spi_settings);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
+  _setPartialRamArea(x1, y1, w1, h1, IT8951_2BPP);
+  _transport->beginTransaction(_spi_settings);
   _transfer16(0x0000); // preamble for write data
   _waitWhileBusy2("writeImage preamble", default_wait_time);
+  uint8_t row[WIDTH / 4]; // 2bpp
   for (int16_t i = 0; i < h1; i++)
   {
     for (int16_t j = 0; j < w1 / 8; j++)
@@ -262,11 +252,14 @@ void GxEPD2_it60_1448x1072::writeImagePart(const uint8_t bitmap[], int16_t x_par
         data = bitmap[idx];
       }
       if (invert) data = ~data;
-      _send8pixel(~data);
+      uint16_t pixels = _pack2bpp(data);
+      row[2 * j] = pixels >> 8;
+      row[2 * j + 1] = pixels & 0xFF;
     }
+    GxEPD2_STATS_DATA(w1 / 4);
+    _transport->writeData(row, w1 / 4);
   }
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _transport->endTransaction();
   _writeCommand16(IT8951_TCON_LD_IMG_END);
   _waitWhileBusy2("writeImage load end", default_wait_time);
   delay(1); // yield() to avoid WDT on ESP8266 and ESP32
@@ -305,45 +298,71 @@ void GxEPD2_it60_1448x1072::writeNative(const uint8_t* data1, const uint8_t* dat
     h1 -= dy;
     if ((w1 <= 0) || (h1 <= 0)) return;
     if (!_using_partial_mode) _Init_Part();
-    _setPartialRamArea(x1, y1, w1, h1);
-    SPI.beginTransaction(_spi_settings);
-    if (_cs >= 0) digitalWrite(_cs, LOW);
+    _grey_loaded = true;
+    _setPartialRamArea(x1, y1, w1, h1, IT8951_8BPP);
+    _transport->beginTransaction(_spi_settings);
     _transfer16(0x0000); // preamble for write data
     _waitWhileBusy2("writeNative preamble", default_wait_time);
     for (int16_t i = 0; i < h1; i++)
     {
-      for (int16_t j = 0; j < w1; j++)
-      {
-        uint8_t data;
-        // use w, h of bitmap for index!
-        uint32_t idx = mirror_y ? uint32_t(j + dx) + uint32_t((h - 1 - (i + dy))) * uint32_t(w) : uint32_t(j + dx) + uint32_t(i + dy) * uint32_t(w);
-        if (pgm)
-        {
-#if defined(__AVR) || defined(ESP8266) || defined(ESP32)
-          data = pgm_read_byte(&data1[idx]);
-#else
-          data = data1[idx];
-#endif
-        }
-        else
-        {
-          data = data1[idx];
-        }
-        if (invert) data = ~data;
-        SPI.transfer(data);
-      }
+      // use w, h of bitmap for index!
+      uint32_t idx = mirror_y ? uint32_t(dx) + uint32_t((h - 1 - (i + dy))) * uint32_t(w) : uint32_t(dx) + uint32_t(i + dy) * uint32_t(w);
+      _transfer(&data1[idx], w1, invert, pgm);
 #if defined(ESP8266) || defined(ESP32)
       yield();
 #endif
     }
-    if (_cs >= 0) digitalWrite(_cs, HIGH);
-    SPI.endTransaction();
+    _transport->endTransaction();
     _writeCommand16(IT8951_TCON_LD_IMG_END);
     _waitWhileBusy2("writeNative load end", default_wait_time);
     delay(1); // yield() to avoid WDT on ESP8266 and ESP32
   }
 }
 
+void GxEPD2_it60_1448x1072::writeNative4bpp(const uint8_t* data, int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
+{
+  if (_initial_write) writeScreenBuffer(); // initial full screen buffer clean
+  delay(1); // yield() to avoid WDT on ESP8266 and ESP32
+  int16_t wb = (w + 1) / 2; // width bytes, rows are padded
+  x -= x % 4; // word boundary
+  w = wb * 2; // byte boundary
+  int16_t x1 = x < 0 ? 0 : x; // limit
+  int16_t y1 = y < 0 ? 0 : y; // limit
+  int16_t w1 = x + w < int16_t(WIDTH) ? w : int16_t(WIDTH) - x; // limit
+  int16_t h1 = y + h < int16_t(HEIGHT) ? h : int16_t(HEIGHT) - y; // limit
+  int16_t dx = x1 - x;
+  int16_t dy = y1 - y;
+  w1 -= dx;
+  h1 -= dy;
+  w1 -= w1 % 4; // whole words of 4 pixels
+  if ((w1 <= 0) || (h1 <= 0)) return;
+  if (!_using_partial_mode) _Init_Part();
+  _grey_loaded = true;
+  _setPartialRamArea(x1, y1, w1, h1, IT8951_4BPP);
+  _transport->beginTransaction(_spi_settings);
+  _transfer16(0x0000); // preamble for write data
+  _waitWhileBusy2("writeNative4bpp preamble", default_wait_time);
+  for (int16_t i = 0; i < h1; i++)
+  {
+    // use wb, h of bitmap for index!
+    uint32_t idx = mirror_y ? uint32_t(dx / 2) + uint32_t((h - 1 - (i + dy))) * uint32_t(wb) : uint32_t(dx / 2) + uint32_t(i + dy) * uint32_t(wb);
+    _transfer(&data[idx], w1 / 2, invert, pgm);
+#if defined(ESP8266) || defined(ESP32)
+    yield();
+#endif
+  }
+  _transport->endTransaction();
+  _writeCommand16(IT8951_TCON_LD_IMG_END);
+  _waitWhileBusy2("writeNative4bpp load end", default_wait_time);
+  delay(1); // yield() to avoid WDT on ESP8266 and ESP32
+}
+
+void GxEPD2_it60_1448x1072::drawNative4bpp(const uint8_t* data, int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
+{
+  writeNative4bpp(data, x, y, w, h, invert, mirror_y, pgm);
+  _refresh(x, y, w, h, false);
+}
+
 void GxEPD2_it60_1448x1072::drawImage(const uint8_t bitmap[], int16_t x, int16_t y, int16_t w, int16_t h, bool invert, bool mirror_y, bool pgm)
 {
   writeImage(bitmap, x, y, w, h, invert, mirror_y, pgm);
@@ -386,7 +405,35 @@ void GxEPD2_it60_1448x1072::refresh(int16_t x, int16_t y, int16_t w, int16_t h)
   _refresh(x, y, w, h, true);
 }
 
+void GxEPD2_it60_1448x1072::refresh(int16_t x, int16_t y, int16_t w, int16_t h, WaveformMode mode)
+{
+  _refresh(x, y, w, h, mode);
+}
+
+void GxEPD2_it60_1448x1072::setPartialWaveform(WaveformMode mode)
+{
+  _partial_waveform = mode;
+}
+
+void GxEPD2_it60_1448x1072::setGhostingLimit(uint16_t fast_refreshes)
+{
+  _ghosting_limit = fast_refreshes;
+}
+
 void GxEPD2_it60_1448x1072::_refresh(int16_t x, int16_t y, int16_t w, int16_t h, bool partial_update_mode)
+{
+  _refresh(x, y, w, h, partial_update_mode ? _partial_waveform : GC16);
+}
+
+GxEPD2_it60_1448x1072::WaveformMode GxEPD2_it60_1448x1072::_autoWaveform(int16_t w, int16_t h)
+{
+  if (_grey_loaded) return GC16;
+  if ((_ghosting_limit > 0) && (_fast_refreshes >= _ghosting_limit)) return GC16;
+  // A2 for small areas like cursors or tickers, DU copes better with leftovers of grey content
+  return uint32_t(w) * uint32_t(h) <= uint32_t(WIDTH) * uint32_t(HEIGHT) / 8 ? A2 : DU;
+}
+
+void GxEPD2_it60_1448x1072::_refresh(int16_t x, int16_t y, int16_t w, int16_t h, WaveformMode mode)
 {
   //x -= x % 8; // byte boundary
   //w -= x % 8; // byte boundary
@@ -396,6 +443,17 @@ void GxEPD2_it60_1448x1072::_refresh(int16_t x, int16_t y, int16_t w, int16_t h,
   int16_t h1 = y + h < int16_t(HEIGHT) ? h : int16_t(HEIGHT) - y; // limit
   w1 -= x1 - x;
   h1 -= y1 - y;
+  if (mode == AUTO) mode = _autoWaveform(w1, h1);
+#ifdef GxEPD2_STATS
+  if ((w1 == int16_t(WIDTH)) && (h1 == int16_t(HEIGHT))) _stats.full_refreshes++;
+  else _stats.partial_refreshes++;
+#endif
+  if ((mode == A2) || (mode == DU)) _fast_refreshes++;
+  else
+  {
+    if (mode != GL16) _fast_refreshes = 0;
+    _grey_loaded = false;
+  }
   //Send I80 Display Command (User defined command of IT8951)
   _writeCommand16(USDEF_I80_CMD_DPY_AREA); //0x0034
   _waitWhileBusy2("refresh cmd", refresh_cmd_time);
@@ -408,8 +466,8 @@ void GxEPD2_it60_1448x1072::_refresh(int16_t x, int16_t y, int16_t w, int16_t h,
   _waitWhileBusy2("refresh w", refresh_par_time);
   _writeData16(h1);
   _waitWhileBusy2("refresh h", refresh_par_time);
-  _writeData16(partial_update_mode ? 1 : 2); // mode
-  _waitWhileBusy("refresh", full_refresh_time);
+  _writeData16(mode == A2 ? uint16_t(_a2_mode) : uint16_t(mode)); // mode
+  _waitWhileBusy("refresh", (mode == A2) || (mode == DU) ? partial_refresh_time : full_refresh_time);
 }
 
 void GxEPD2_it60_1448x1072::powerOff(void)
@@ -430,22 +488,23 @@ void GxEPD2_it60_1448x1072::hibernate()
   }
 }
 
-void GxEPD2_it60_1448x1072::_send8pixel(uint8_t data)
+uint16_t GxEPD2_it60_1448x1072::_pack2bpp(uint8_t data)
 {
-  for (uint8_t j = 0; j < 8; j++)
-  {
-    SPI.transfer(data & 0x80 ? 0x00 : 0xFF);
-    data <<= 1;
-  }
+  // spread bit n to bits 2n and 2n+1, 1 (white) becomes 3; big endian load keeps the leftmost pixel in the top bits
+  uint16_t v = data;
+  v = (v | (v << 4)) & 0x0F0F;
+  v = (v | (v << 2)) & 0x3333;
+  v = (v | (v << 1)) & 0x5555;
+  return v | (v << 1);
 }
 
-void GxEPD2_it60_1448x1072::_setPartialRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+void GxEPD2_it60_1448x1072::_setPartialRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t bpp)
 {
   //_IT8951WriteReg(LISAR + 2 , IT8951DevInfo.usImgBufAddrH);
   //_IT8951WriteReg(LISAR , IT8951DevInfo.usImgBufAddrL);
   uint16_t usArg[5];
   //usArg[0] = (IT8951_LDIMG_L_ENDIAN << 8 ) | (IT8951_8BPP << 4) | (IT8951_ROTATE_0);
-  usArg[0] = (IT8951_LDIMG_B_ENDIAN << 8 ) | (IT8951_8BPP << 4) | (IT8951_ROTATE_0);
+  usArg[0] = (IT8951_LDIMG_B_ENDIAN << 8 ) | (bpp << 4) | (IT8951_ROTATE_0);
   usArg[1] = x;
   usArg[2] = y;
   usArg[3] = w;
@@ -455,6 +514,7 @@ void GxEPD2_it60_1448x1072::_setPartialRamArea(uint16_t x, uint16_t y, uint16_t
 
 void GxEPD2_it60_1448x1072::_PowerOn()
 {
+  GxEPD2_STATS_TIME(POWER_ON);
   if (!_power_is_on)
   {
     _IT8951SystemRun();
@@ -465,6 +525,7 @@ void GxEPD2_it60_1448x1072::_PowerOn()
 
 void GxEPD2_it60_1448x1072::_PowerOff()
 {
+  GxEPD2_STATS_TIME(POWER_OFF);
   _IT8951StandBy();
   _waitWhileBusy("_PowerOff", power_off_time);
   _power_is_on = false;
@@ -499,18 +560,13 @@ void GxEPD2_it60_1448x1072::_Init_Part()
 
 void GxEPD2_it60_1448x1072::_waitWhileBusy2(const char* comment, uint16_t busy_time)
 {
+  GxEPD2_STATS_TIME(BUSY);
   if (_busy >= 0)
   {
     unsigned long start = micros();
-    while (1)
+    if (!_transport->waitWhileBusy(_busy_timeout))
     {
-      if (digitalRead(_busy) != _busy_level) break;
-      delay(1);
-      if (micros() - start > _busy_timeout)
-      {
-        Debug("Busy Timeout!\n");
-        break;
-      }
+      Debug("Busy Timeout!\n");
     }
     if (comment)
     {
@@ -532,8 +588,8 @@ void GxEPD2_it60_1448x1072::_waitWhileBusy2(const char* comment, uint16_t busy_t
 
 uint16_t GxEPD2_it60_1448x1072::_transfer16(uint16_t value)
 {
-  uint16_t rv = SPI.transfer(value >> 8) << 8;
-  return (rv | SPI.transfer(value));
+  uint16_t rv = _transport->transfer(value >> 8) << 8;
+  return (rv | _transport->transfer(value));
 }
 
 void GxEPD2_it60_1448x1072::_writeCommand16(uint16_t c)
@@ -546,63 +602,54 @@ void GxEPD2_it60_1448x1072::_writeCommand16(uint16_t c)
   String s = String("_writeCommand16(0x") + String(c, HEX) + String(")");
   _waitWhileBusy2(s.c_str(), default_wait_time);
 #endif
-  SPI.beginTransaction(_spi_settings);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
+  _transport->beginTransaction(_spi_settings);
   _transfer16(0x6000); // preamble for write command
   _waitWhileBusy2("_writeCommand16 preamble", default_wait_time);
   _transfer16(c);
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _transport->endTransaction();
   //_waitWhileBusy(s.c_str(), default_wait_time);
 }
 
 void GxEPD2_it60_1448x1072::_writeData16(uint16_t d)
 {
   _waitWhileBusy2("_writeData16", default_wait_time);
-  SPI.beginTransaction(_spi_settings);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
+  _transport->beginTransaction(_spi_settings);
   _transfer16(0x0000); // preamble for write data
   _waitWhileBusy2("_writeData16 preamble", default_wait_time);
   _transfer16(d);
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _transport->endTransaction();
 }
 
 void GxEPD2_it60_1448x1072::_writeData16(const uint16_t* d, uint32_t n)
 {
   _waitWhileBusy2("_writeData16", default_wait_time);
-  SPI.beginTransaction(_spi_settings);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
+  _transport->beginTransaction(_spi_settings);
   _transfer16(0x0000); // preamble for write data
   _waitWhileBusy2("_writeData16 preamble", default_wait_time);
   for (uint32_t i = 0; i < n; i++)
   {
     _transfer16(*d++);
   }
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _transport->endTransaction();
 }
 
 uint16_t GxEPD2_it60_1448x1072::_readData16()
 {
   _waitWhileBusy2("_readData16", default_wait_time);
-  SPI.beginTransaction(_spi_settings);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
+  _transport->beginTransaction(_spi_settings_for_read);
   _transfer16(0x1000); // preamble for read data
   _waitWhileBusy2("_readData16 preamble", default_wait_time);
   _transfer16(0); // dummy
   _waitWhileBusy2("_readData16 dummy", default_wait_time);
   uint16_t rv = _transfer16(0);
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _transport->endTransaction();
   return rv;
 }
 
 void GxEPD2_it60_1448x1072::_readData16(uint16_t* d, uint32_t n)
 {
   _waitWhileBusy2("_readData16", default_wait_time);
-  SPI.beginTransaction(_spi_settings);
-  if (_cs >= 0) digitalWrite(_cs, LOW);
+  _transport->beginTransaction(_spi_settings_for_read);
   _transfer16(0x1000); // preamble for read data
   _waitWhileBusy2("_readData16 preamble", default_wait_time);
   _transfer16(0); // dummy
@@ -612,8 +659,7 @@ void GxEPD2_it60_1448x1072::_readData16(uint16_t* d, uint32_t n)
     *d++ = _transfer16(0);
     //_waitWhileBusy("_readData16 data", default_wait_time);
   }
-  if (_cs >= 0) digitalWrite(_cs, HIGH);
-  SPI.endTransaction();
+  _transport->endTransaction();
 }
 
 void GxEPD2_it60_1448x1072::_writeCommandData16(uint16_t c, const uint16_t* d, uint16_t n)
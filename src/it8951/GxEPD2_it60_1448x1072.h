@@ -38,6 +38,18 @@ class GxEPD2_it60_1448x1072 : public GxEPD2_EPD
     static const uint16_t refresh_par_time = 2; // ms, e.g. 1921us
     static const uint16_t default_wait_time = 1; // ms, default busy check, needed?
     static const uint16_t diag_min_time = 3; // ms, e.g. > refresh_par_time
+    static const uint32_t spi_clock = 24000000; // Hz, max. write clock of IT8951
+    static const uint32_t spi_read_clock = 1000000; // Hz, for reading registers and status
+    // waveform modes of the IT8951 display command
+    enum WaveformMode
+    {
+      INIT = 0, // clears to white, flashing; against strong ghosting
+      DU = 1, // fast, to black or white only
+      GC16 = 2, // 16 grey levels, flashing; clears ghosting
+      GL16 = 3, // 16 grey levels, less flashing on white background
+      A2 = 6, // fastest, black and white content only; sent as 4 for M641 LUT panels
+      AUTO = 0xFF // partial refresh: A2 or DU for black and white content, GC16 for grey levels and after ghosting limit
+    };
     static const uint16_t set_vcom_time = 500; // ms, e.g. 408377us
     // constructor
     GxEPD2_it60_1448x1072(int8_t cs, int8_t dc, int8_t rst, int8_t busy);
@@ -65,8 +77,16 @@ class GxEPD2_it60_1448x1072 : public GxEPD2_EPD
                        int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false);
     // write sprite of native data to controller memory, with screen refresh; x and w should be multiple of 8
     void drawNative(const uint8_t* data1, const uint8_t* data2, int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false);
+    // write sprite of 4bpp grey levels to controller memory, without screen refresh; x and w should be multiple of 4
+    // 2 pixels per byte, left pixel in high nibble, 0x0 is black, 0xF is white
+    void writeNative4bpp(const uint8_t* data, int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false);
+    // write sprite of 4bpp grey levels to controller memory, with screen refresh; x and w should be multiple of 4
+    void drawNative4bpp(const uint8_t* data, int16_t x, int16_t y, int16_t w, int16_t h, bool invert = false, bool mirror_y = false, bool pgm = false);
     void refresh(bool partial_update_mode = false); // screen refresh from controller memory to full screen
     void refresh(int16_t x, int16_t y, int16_t w, int16_t h); // screen refresh from controller memory, partial screen
+    void refresh(int16_t x, int16_t y, int16_t w, int16_t h, WaveformMode mode); // screen refresh with waveform mode
+    void setPartialWaveform(WaveformMode mode); // waveform used for partial refresh, default DU, AUTO selects per refresh
+    void setGhostingLimit(uint16_t fast_refreshes); // AUTO uses GC16 after this many A2 or DU refreshes, 0: never
     void powerOff(); // turns off generation of panel driving voltages, avoids screen fading over time
     void hibernate(); // turns powerOff() and sets controller to deep sleep for minimum power use, ONLY if wakeable by RST (rst >= 0)
   private:
@@ -80,13 +100,18 @@ class GxEPD2_it60_1448x1072 : public GxEPD2_EPD
       uint16_t usLUTVersion[8];   //16 Bytes String
     };
     IT8951DevInfoStruct IT8951DevInfo;
-    SPISettings _spi_settings;
     SPISettings _spi_settings_for_read;
+    WaveformMode _partial_waveform;
+    uint16_t _ghosting_limit, _fast_refreshes;
+    uint16_t _a2_mode; // A2 mode number of the panel LUT
+    bool _grey_loaded; // grey levels written since last grey level refresh
   private:
     void _writeScreenBuffer(uint8_t value);
     void _refresh(int16_t x, int16_t y, int16_t w, int16_t h, bool partial_update_mode);
-    void _send8pixel(uint8_t data);
-    void _setPartialRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+    void _refresh(int16_t x, int16_t y, int16_t w, int16_t h, WaveformMode mode);
+    WaveformMode _autoWaveform(int16_t w, int16_t h);
+    static uint16_t _pack2bpp(uint8_t data); // 8 pixels of 1bpp to 2bpp
+    void _setPartialRamArea(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t bpp);
     void _PowerOn();
     void _PowerOff();
     void _InitDisplay();